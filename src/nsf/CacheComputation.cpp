@@ -22,12 +22,14 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #include <iostream>
 
 #include "CacheComputation.h"
+#include "ComputationManager.h"
 #include "cuddInt.h"
 
 CacheComputation::CacheComputation(ComputationManager& manager, const std::vector<NTYPE>& quantifierSequence, const std::vector<BDD>& cubesAtLevels, const BDD& bdd, unsigned int maxBDDsize, bool keepFirstLevel)
 : Computation(manager, quantifierSequence, cubesAtLevels, bdd)
 , _keepFirstLevel(keepFirstLevel)
 , _maxBDDsize(maxBDDsize)
+, _batchAbstractions(false)
 {
     _removeCache = new std::vector<std::vector < BDD >> (quantifierSequence.size());
 }
@@ -36,6 +38,7 @@ CacheComputation::CacheComputation(const CacheComputation& other)
 : Computation(other)
 , _keepFirstLevel(other._keepFirstLevel)
 , _maxBDDsize(other._maxBDDsize)
+, _batchAbstractions(false)
 {
     _removeCache = new std::vector<std::vector < BDD >> (other._removeCache->size());
     for (unsigned int level = 1; level <= other._removeCache->size(); level++) {
@@ -48,8 +51,8 @@ CacheComputation::~CacheComputation() {
         delete _removeCache;
 }
 
-void CacheComputation::conjunct(const Computation& other) {
-    Computation::conjunct(other);
+void CacheComputation::conjunct(const Computation& other, bool lazy) {
+    Computation::conjunct(other, lazy);
     try {
         // check if other contains a remove cache
         const CacheComputation& t = dynamic_cast<const CacheComputation&> (other);
@@ -66,8 +69,14 @@ void CacheComputation::remove(const std::vector<std::vector<BDD>>&removedVertice
     addToRemoveCache(removedVertices);
 }
 
+/**
+ * Innermost variables are never cached (see addToRemoveCache), hence they can
+ * be abstracted together with the clauses.
+ **/
 void CacheComputation::removeApply(const std::vector<std::vector<BDD>>&removedVertices, const std::vector<BDD>& cubesAtLevels, const BDD& clauses) {
-    apply(cubesAtLevels, clauses);
+    if ((_keepFirstLevel && removedVertices.size() == 1) || !applyAbstract(removedVertices, cubesAtLevels, clauses)) {
+        apply(cubesAtLevels, clauses);
+    }
     addToRemoveCache(removedVertices);
 }
 
@@ -84,7 +93,7 @@ BDD CacheComputation::truncate(std::vector<BDD>& cubesAtlevels) {
     return Computation::truncate(cubesAtlevels);
 }
 
-BDD CacheComputation::evaluate(std::vector<BDD>& cubesAtlevels, bool keepFirstLevel) {
+void CacheComputation::addEvaluationCubes(std::vector<BDD>& cubesAtlevels) {
     for (unsigned int level = 1; level <= _removeCache->size(); level++) {
         for (BDD b : _removeCache->at(level - 1)) {
             if (cubesAtlevels.size() < level) {
@@ -94,7 +103,7 @@ BDD CacheComputation::evaluate(std::vector<BDD>& cubesAtlevels, bool keepFirstLe
             }
         }
     }
-    return Computation::evaluate(cubesAtlevels, keepFirstLevel);
+    Computation::addEvaluationCubes(cubesAtlevels);
 }
 
 RESULT CacheComputation::decide() {
@@ -114,17 +123,30 @@ BDD CacheComputation::solutions() {
     return evaluate(cubesAtlevels, true);
 }
 
+/**
+ * With an adaptive split limit, the limit currently set by the manager is used.
+ **/
 bool CacheComputation::optimize() {
+    if (manager.useAdaptiveSplitLimit()) {
+        _maxBDDsize = manager.splitLimit();
+    }
+    minimizeIfTooLarge();
     if (reduceRemoveCache()) {
         Computation::optimize();
+        manager.countRemovalResult(leavesCount(), maxBDDsize());
         return true;
     }
     return false;
 }
 
 bool CacheComputation::optimize(bool left) {
+    if (manager.useAdaptiveSplitLimit()) {
+        _maxBDDsize = manager.splitLimit();
+    }
+    minimizeIfTooLarge();
     if (reduceRemoveCache()) {
         Computation::optimize(left);
+        manager.countRemovalResult(leavesCount(), maxBDDsize());
         return true;
     }
     return false;
@@ -156,12 +178,21 @@ bool CacheComputation::isRemoveCacheReducible() {
     return false;
 }
 
+/**
+ * Leaves that exceed the split limit may already fit once their don't cares
+ * are exploited, hence they are minimized before a split is considered.
+ **/
+void CacheComputation::minimizeIfTooLarge() {
+    if (manager.useDontCareMinimization() && isRemoveCacheReducible()) {
+        minimize();
+    }
+}
+
 bool CacheComputation::reduceRemoveCache() {
     if (isRemoveCacheReducible()) {
-        // possibly add options for removal strategies (orderings) here
         for (unsigned int vl = _removeCache->size(); vl >= 1; vl--) {
             if (isRemovableAtRemoveCacheLevel(vl)) {
-                BDD toRemove = popFirstFromRemoveCache(vl); // simulate fifo
+                BDD toRemove = selectFromRemoveCache(vl);
                 Computation::remove(toRemove, vl);
                 return true;
             }
@@ -184,12 +215,22 @@ void CacheComputation::addToRemoveCache(BDD variable, const unsigned int vl) {
     }
 }
 
+/**
+ * Abstractions are collected per level and flushed before the next level is
+ * handled, hence the order of operations on the NSF across levels is kept.
+ **/
 void CacheComputation::addToRemoveCache(const std::vector<std::vector<BDD>>&variables) {
+    _batchAbstractions = true;
     for (unsigned int vl = 1; vl <= variables.size(); vl++) {
         for (BDD variable : variables.at(vl - 1)) {
             addToRemoveCache(variable, vl);
         }
+        if (!_abstractionBatch.empty()) {
+            Computation::removeAbstract(_abstractionBatch, vl);
+            _abstractionBatch.clear();
+        }
     }
+    _batchAbstractions = false;
 }
 
 void CacheComputation::removeFromRemoveCache(BDD variable, const unsigned int vl) {
@@ -216,6 +257,35 @@ BDD CacheComputation::popFirstFromRemoveCache(const unsigned int vl) {
     return b;
 }
 
+/**
+ * Pops the variable chosen by the removal strategy,
+ * isRemovableAtRemoveCacheLevel(vl) must return true
+ */
+BDD CacheComputation::selectFromRemoveCache(const unsigned int vl) {
+    std::vector<BDD>& variables = _removeCache->at(vl - 1);
+    manager.countRemovalSelection(variables.size(), leavesCount(), maxBDDsize());
+    std::clock_t begin = std::clock();
+    unsigned int position = manager.getRemoveCacheStrategy().select(variables, *_nsf);
+    manager.addRemovalSelectionTime(std::clock() - begin);
+    std::iter_swap(variables.begin() + position, variables.end() - 1);
+    BDD b = variables.back();
+    variables.pop_back();
+    return b;
+}
+
+/**
+ * Variables that are independent of all remaining ones are abstracted right
+ * away, or together with the other variables of their level if several
+ * variables are added at once.
+ **/
+void CacheComputation::abstractBatched(const BDD& variable, const unsigned int vl) {
+    if (_batchAbstractions) {
+        _abstractionBatch.push_back(variable);
+    } else {
+        Computation::removeAbstract(variable, vl);
+    }
+}
+
 bool CacheComputation::isRemovableRemoveCache() const {
     for (unsigned int vl = 1; vl <= _removeCache->size(); vl++) {
         if (isRemovableAtRemoveCacheLevel(vl))
@@ -31,7 +31,7 @@ public:
 
     ~CacheComputation();
 
-    virtual void conjunct(const Computation& other) override;
+    virtual void conjunct(const Computation& other, bool lazy) override;
 
     virtual void remove(const BDD& variable, const unsigned int vl) override;
     virtual void remove(const std::vector<std::vector<BDD>>&removedVertices) override;
@@ -53,13 +53,15 @@ public:
     bool _keepFirstLevel;
     
 protected:
-    virtual BDD evaluate(std::vector<BDD>& cubesAtlevels, bool keepFirstLevel) override;
+    virtual void addEvaluationCubes(std::vector<BDD>& cubesAtlevels) override;
 
     virtual void addToRemoveCache(BDD variable, const unsigned int vl);
     void addToRemoveCache(const std::vector<std::vector<BDD>>&variables);
     void removeFromRemoveCache(BDD variable, const unsigned int vl);
     BDD popFromRemoveCache(const unsigned int vl);
     BDD popFirstFromRemoveCache(const unsigned int vl);
+    BDD selectFromRemoveCache(const unsigned int vl);
+    void abstractBatched(const BDD& variable, const unsigned int vl);
 
     bool isRemoveCacheReducible();
     virtual bool reduceRemoveCache();
@@ -69,5 +71,11 @@ protected:
     std::vector<std::vector<BDD>>*_removeCache;
     
 private:
+    void minimizeIfTooLarge();
+
     unsigned int _maxBDDsize;
+
+    // variables of the current level that are abstracted together (while adding several variables)
+    bool _batchAbstractions;
+    std::vector<BDD> _abstractionBatch;
 };
@@ -25,19 +25,9 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #include "ComputationManager.h"
 
 Computation::Computation(ComputationManager& manager, const std::vector<NTYPE>& quantifierSequence, const std::vector<BDD>& cubesAtLevels, const BDD& bdd)
-: manager(manager) {
-    unsigned int level = quantifierSequence.size();
-    unsigned int depth = 0;
-    NSF* current = new NSF(level, depth, quantifierSequence.at(level - 1));
-    current->setValue(bdd);
-    while (level > 1) {
-        level--;
-        depth++;
-        NSF* parent = new NSF(level, depth, quantifierSequence.at(level - 1));
-        parent->insertNSF(current);
-        current = parent;
-    }
-    _nsf = current;
+: manager(manager)
+, _id(manager.newComputationId()) {
+    _nsf = manager.newNSF(quantifierSequence, bdd);
 
     _variableDomain = new std::vector<BDD>();
     for (unsigned int level = 1; level <= cubesAtLevels.size(); level++) {
@@ -46,8 +36,9 @@ Computation::Computation(ComputationManager& manager, const std::vector<NTYPE>&
 }
 
 Computation::Computation(const Computation& other)
-: manager(other.manager) {
-    _nsf = new NSF(*(other._nsf));
+: manager(other.manager)
+, _id(other.manager.newComputationId()) {
+    _nsf = other._nsf->copy();
     _variableDomain = new std::vector<BDD>(*(other._variableDomain));
 }
 
@@ -56,19 +47,31 @@ Computation::~Computation() {
     delete _variableDomain;
 }
 
-void Computation::apply(const std::vector<BDD>& cubesAtLevels, std::function<BDD(const BDD&)> f) {
+unsigned long Computation::id() const {
+    return _id;
+}
+
+void Computation::apply(const std::vector<BDD>& cubesAtLevels, const std::function<BDD(const BDD&)>& f) {
     addToVariableDomain(cubesAtLevels);
     _nsf->apply(f);
 }
 
 void Computation::apply(const std::vector<BDD>& cubesAtLevels, const BDD& clauses) {
     addToVariableDomain(cubesAtLevels);
-    _nsf->apply(clauses);
+    if (manager.useLazyClauses()) {
+        _nsf->applyLazily(clauses);
+    } else {
+        _nsf->apply(clauses);
+    }
 }
 
-void Computation::conjunct(const Computation& other) {
+void Computation::conjunct(const Computation& other, bool lazy) {
     addToVariableDomain(*(other._variableDomain));
-    _nsf->conjunct(*(other._nsf));
+    if (lazy) {
+        _nsf->conjunctLazily(*(other._nsf), manager.useAntichainJoin());
+    } else {
+        _nsf->conjunct(*(other._nsf), manager.useAntichainJoin());
+    }
 }
 
 void Computation::removeAbstract(const BDD& variable, const unsigned int vl) {
@@ -80,6 +83,30 @@ void Computation::removeAbstract(const BDD& variable, const unsigned int vl) {
     _nsf->removeAbstract(variable, vl);
 }
 
+/**
+ * Abstracts variables of the same level with a single cube, i.e. each leaf is
+ * traversed once instead of once per variable.
+ **/
+void Computation::removeAbstract(const std::vector<BDD>& variables, const unsigned int vl) {
+    if (variables.size() == 1) {
+        removeAbstract(variables.front(), vl);
+        return;
+    }
+    BDD cube = variables.front();
+    for (unsigned int it = 1; it < variables.size(); it++) {
+        cube *= variables.at(it);
+    }
+    removeFromVariableDomain(cube, vl);
+    for (unsigned int it = 0; it < variables.size(); it++) {
+        if (vl < _variableDomain->size()) {
+            manager.incrementInternalAbstractCount();
+        }
+        manager.incrementAbstractCount();
+    }
+    manager.addAbstractionBatch(variables.size());
+    _nsf->removeAbstract(cube, vl);
+}
+
 
 void Computation::remove(const BDD& variable, const unsigned int vl) {
     removeFromVariableDomain(variable, vl);
@@ -88,7 +115,7 @@ void Computation::remove(const BDD& variable, const unsigned int vl) {
     } else {
         manager.incrementAbstractCount(); // innermost are always abstracted
     }
-    _nsf->remove(variable, vl);
+    manager.addAvoidedSplitCopies(_nsf->remove(variable, vl));
 }
 
 void Computation::remove(const std::vector<std::vector<BDD>>& removedVertices) {
@@ -97,11 +124,13 @@ void Computation::remove(const std::vector<std::vector<BDD>>& removedVertices) {
             removeFromVariableDomain(variable, level);
         }
     }
-    _nsf->remove(removedVertices);
+    manager.addAvoidedSplitCopies(_nsf->remove(removedVertices));
 }
 
 void Computation::removeApply(const std::vector<std::vector<BDD>>&removedVertices, const std::vector<BDD>& cubesAtLevels, const BDD& clauses) {
-    apply(cubesAtLevels, clauses);
+    if (!applyAbstract(removedVertices, cubesAtLevels, clauses)) {
+        apply(cubesAtLevels, clauses);
+    }
     remove(removedVertices);
 }
 
@@ -113,8 +142,10 @@ bool Computation::optimize(bool left) {
     return _nsf->optimize(left);
 }
 
-void Computation::sortByIncreasingSize() {
-    _nsf->sortByIncreasingSize();
+void Computation::minimize() {
+    _nsf->minimize([this](const BDD& leaf, const BDD& careSet) -> BDD {
+        return manager.minimize(leaf, careSet);
+    });
 }
 
 const unsigned int Computation::maxBDDsize() const {
@@ -149,6 +180,11 @@ BDD Computation::truncate(std::vector<BDD>& cubesAtlevels) {
 }
 
 BDD Computation::evaluate(std::vector<BDD>& cubesAtlevels, bool keepFirstLevel) {
+    addEvaluationCubes(cubesAtlevels);
+    return _nsf->evaluate(cubesAtlevels, keepFirstLevel);
+}
+
+void Computation::addEvaluationCubes(std::vector<BDD>& cubesAtlevels) {
     // assert cubesAtLevels.size() == _variableDomain->size()
     for (unsigned int level = 1; level <= _variableDomain->size(); level++) {
         if (cubesAtlevels.size() < level) {
@@ -157,7 +193,6 @@ BDD Computation::evaluate(std::vector<BDD>& cubesAtlevels, bool keepFirstLevel)
             cubesAtlevels.at(level - 1) *= _variableDomain->at(level - 1);
         }
     }
-    return _nsf->evaluate(cubesAtlevels, keepFirstLevel);
 }
 
 bool Computation::isUnsat() const {
@@ -177,6 +212,48 @@ RESULT Computation::decide() {
     }
 }
 
+/**
+ * Intermediate check that gives up (UNDECIDED) once the evaluated leaves
+ * exceed budget BDD nodes, 0 for no limit.
+ **/
+RESULT Computation::decideWithinBudget(unsigned long budget) {
+    std::vector<BDD> cubesAtlevels;
+    addEvaluationCubes(cubesAtlevels);
+    bool withinBudget;
+    BDD decide = _nsf->evaluate(cubesAtlevels, false, budget, withinBudget);
+    if (!withinBudget) {
+        return RESULT::UNDECIDED;
+    } else if (decide.IsZero()) {
+        return RESULT::UNSAT;
+    } else if (decide.IsOne()) {
+        return RESULT::SAT;
+    } else {
+        return RESULT::UNDECIDED;
+    }
+}
+
+/**
+ * Intermediate check on the bound obtained by evaluating approximate(leaf)
+ * instead of the leaves, an upper bound if upperBound and a lower bound
+ * otherwise. Only a false upper bound (UNSAT) or a true lower bound (SAT)
+ * decides. The NSF is neither modified nor materialized.
+ **/
+RESULT Computation::decideApproximation(const std::function<BDD(const BDD&)>& approximate, bool upperBound) {
+    std::vector<BDD> cubesAtlevels;
+    addEvaluationCubes(cubesAtlevels);
+    bool bounded;
+    BDD bound = _nsf->evaluateApproximation(cubesAtlevels, approximate, upperBound, bounded);
+    if (!bounded) {
+        return RESULT::UNDECIDED;
+    } else if (upperBound && bound.IsZero()) {
+        return RESULT::UNSAT;
+    } else if (!upperBound && bound.IsOne()) {
+        return RESULT::SAT;
+    } else {
+        return RESULT::UNDECIDED;
+    }
+}
+
 BDD Computation::solutions() {
     std::vector<BDD> cubesAtlevels;
     return evaluate(cubesAtlevels, true);
@@ -194,6 +271,25 @@ const std::vector<BDD>* Computation::getVariableDomain() {
     return _variableDomain;
 }
 
+/**
+ * Conjoins clauses and abstracts the removed innermost variables in a single pass.
+ * The variables stay in the domain, removing them afterwards leaves the NSF unchanged.
+ * Returns false if there is nothing to abstract, then the clauses are not applied.
+ **/
+bool Computation::applyAbstract(const std::vector<std::vector<BDD>>& removedVertices, const std::vector<BDD>& cubesAtLevels, const BDD& clauses) {
+    if (removedVertices.size() != _variableDomain->size() || removedVertices.back().empty()) {
+        return false;
+    }
+    addToVariableDomain(cubesAtLevels);
+    const std::vector<BDD>& innermost = removedVertices.back();
+    BDD cube = innermost.front();
+    for (unsigned int it = 1; it < innermost.size(); it++) {
+        cube *= innermost.at(it);
+    }
+    _nsf->applyAbstract(clauses, cube, removedVertices.size());
+    return true;
+}
+
 void Computation::addToVariableDomain(BDD cube, const unsigned int vl) {
     _variableDomain->at(vl - 1) *= cube;
 }
@@ -30,12 +30,15 @@ public:
 
     virtual ~Computation();
 
-    virtual void apply(const std::vector<BDD>& cubesAtLevels, std::function<BDD(const BDD&)> f);
+    unsigned long id() const;
+
+    virtual void apply(const std::vector<BDD>& cubesAtLevels, const std::function<BDD(const BDD&)>& f);
     virtual void apply(const std::vector<BDD>& cubesAtLevels, const BDD& clauses);
 
-    virtual void conjunct(const Computation& other);
+    virtual void conjunct(const Computation& other, bool lazy);
 
     virtual void removeAbstract(const BDD& variable, const unsigned int vl);
+    void removeAbstract(const std::vector<BDD>& variables, const unsigned int vl);
     
     virtual void remove(const BDD& variable, const unsigned int vl);
     virtual void remove(const std::vector<std::vector<BDD>>& removedVertices);
@@ -43,11 +46,13 @@ public:
 
     virtual bool isUnsat() const;
     virtual RESULT decide();
+    RESULT decideWithinBudget(unsigned long budget);
+    RESULT decideApproximation(const std::function<BDD(const BDD&)>& approximate, bool upperBound);
     virtual BDD solutions();
 
     virtual bool optimize();
     virtual bool optimize(bool left);
-    void sortByIncreasingSize();
+    void minimize();
 
     const unsigned int maxBDDsize() const;
     const unsigned int leavesCount() const;
@@ -61,6 +66,8 @@ public:
 
 protected:
     virtual BDD evaluate(std::vector<BDD>& cubesAtlevels, bool keepFirstLevel);
+    virtual void addEvaluationCubes(std::vector<BDD>& cubesAtlevels);
+    bool applyAbstract(const std::vector<std::vector<BDD>>& removedVertices, const std::vector<BDD>& cubesAtLevels, const BDD& clauses);
     
     ComputationManager& manager;
     NSF* _nsf;
@@ -76,4 +83,6 @@ private:
     void removeFromVariableDomain(const std::vector<BDD>& cubesAtLevels);
     
     std::vector<BDD>* _variableDomain;
+    // unique among all computations of the manager, copies get their own
+    const unsigned long _id;
 };
\ No newline at end of file
@@ -19,6 +19,9 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "../Application.h"
 #include "ComputationManager.h"
 #include "Computation.h"
@@ -26,42 +29,132 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #include "../SolverFactory.h"
 #include "../Utils.h"
 #include "SimpleDependencyCacheComputation.h"
+#include "NodeNSF.h"
+#include "FlatNSF.h"
+#include "PackedNSF.h"
+#include "SymbolicNSF.h"
+#include "FirstRemoveCacheStrategy.h"
+#include "LastRemoveCacheStrategy.h"
+#include "OccurrenceRemoveCacheStrategy.h"
+#include "TrialSplitRemoveCacheStrategy.h"
 
-#ifdef DEPQBF_ENABLED
 #include "StandardDependencyCacheComputation.h"
-#endif
 
 const std::string ComputationManager::NSFMANAGER_SECTION = "NSF Manager";
 
+namespace {
+
+    // approximations of leaves, evaluation is monotone in the leaves
+
+    BDD underApproximation(const BDD& leaf) {
+        if (leaf.IsZero() || leaf.IsOne()) {
+            return leaf;
+        }
+        return leaf.RemapUnderApprox(leaf.SupportSize());
+    }
+
+    BDD overApproximation(const BDD& leaf) {
+        if (leaf.IsZero() || leaf.IsOne()) {
+            return leaf;
+        }
+        return leaf.RemapOverApprox(leaf.SupportSize());
+    }
+}
+
 ComputationManager::ComputationManager(Application& app)
 : app(app)
 , optPrintStats("print-NSF-stats", "Print NSF Manager statistics")
 , optMaxGlobalNSFSize("max-est-NSF-size", "e", "Split until the global estimated NSF size <e> is reached, -1 to disable limit", 125)
 , optMaxBDDSize("max-BDD-size", "b", "Split if a BDD size exceeds <b> (may be overruled by max-est-NSF-size)", 100000)
+, optMinBDDSize("min-BDD-size", "b", "Lower bound <b> for the adapted split limit (see adaptive-BDD-size)", 1000)
+, optAdaptiveBDDSize("adaptive-BDD-size", "Adapt the split limit between min-BDD-size and max-BDD-size, depending on whether BDD sizes or leaf counts grow faster per step")
 , optOptimizeInterval("opt-interval", "o", "Optimize NSF every <o>-th computation step, 0 to disable", 100)
 , optUnsatCheckInterval("unsat-check", "u", "Check for unsatisfiability (and remove unsat NSFs) after every <u>-th computation step, 0 to disable", 2)
-, optSortBeforeJoining("sort-before-joining", "Sort NSFs by increasing size before joining; can increase subset check success rate")
+, optUnsatCheckBudget("unsat-check-budget", "n", "Give up an intermediate unsat check once the evaluated BDDs exceed <n> nodes, 0 to disable", 0)
+, optApproximationCheckInterval("approx-check", "a", "Check for unsatisfiability on over-approximated NSF leaves after every <a>-th computation step (and for satisfiability on under-approximated leaves before the final evaluation), 0 to disable", 0)
+, optLazyJoinSize("lazy-join-size", "j", "Defer joins until their product is needed if its estimated NSF size exceeds <j>, -1 to disable", -1)
+, optAdaptiveIntervals("adaptive-intervals", "Adapt the optimization and unsat check intervals: back off while they do not pay off, optimize more often while compression succeeds")
+, optAntichainJoin("antichain-join", "Join NSFs into antichains, dropping subsumed elements as soon as they are generated")
+, optPackedNSF("packed-NSF", "Additionally store NSFs as arrays per depth, such that evaluation and unsat checks are linear scans")
+, optSymbolicNSF("symbolic-NSF", "Encode NSFs of 2-QBFs as a single BDD over auxiliary index variables")
+, optLazyClauses("lazy-clauses", "Conjoin clauses with NSF leaves only once these are abstracted, compared or evaluated")
+, optDontCareMinimization("dont-care", "m", "Before splitting, minimize NSF leaves using <m> with pending clauses as care set (requires lazy-clauses)")
 , optDependencyScheme("dep-scheme", "d", "Use dependency scheme <d>")
+, optRemoveCacheStrategy("removal-strategy", "s", "Select the cached variable to remove next following strategy <s>")
 , optDisableCache("disable-cache", "Disables removal cache (and sets e: -1, b: 0, d: naive)")
 , maxGlobalNSFSizeEstimation(1)
 , optIntervalCounter(0)
-, optUnsatCheckCounter(0) {
+, optUnsatCheckCounter(0)
+, adaptedSplitLimit(0)
+, splitLimitComputationId(0)
+, splitLimitLeavesCount(0)
+, splitLimitBDDsize(0)
+, splitLimitTrend(0)
+, optimizeInterval(0)
+, unsatCheckInterval(0)
+, lastOptimizeClock(0)
+, lastUnsatCheckClock(0)
+, approximationCheckCounter(0)
+, nextComputationId(1)
+, removeCacheStrategy(NULL)
+, lazyJoinCount(0)
+, avoidedSplitCopies(0)
+, abstractionBatches(0)
+, batchedAbstractions(0)
+, approximationCheckCount(0)
+, approximationDecisionCount(0)
+, optimizeClock(0)
+, unsatCheckClock(0)
+, optimizeIntervalBackoffs(0)
+, optimizeIntervalSpeedups(0)
+, unsatCheckIntervalBackoffs(0)
+, unsatCheckIntervalSpeedups(0)
+, splitLimitDecreases(0)
+, splitLimitIncreases(0)
+, removalSelections(0)
+, removalCandidates(0)
+, removalSelectionClock(0)
+, removalLeavesBefore(0)
+, removalLeavesAfter(0)
+, removalBDDsizeBefore(0)
+, removalBDDsizeAfter(0) {
     app.getOptionHandler().addOption(optOptimizeInterval, NSFMANAGER_SECTION);
     app.getOptionHandler().addOption(optUnsatCheckInterval, NSFMANAGER_SECTION);
-    app.getOptionHandler().addOption(optSortBeforeJoining, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optUnsatCheckBudget, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optApproximationCheckInterval, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optAdaptiveIntervals, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optLazyJoinSize, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optAntichainJoin, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optPackedNSF, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optSymbolicNSF, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optLazyClauses, NSFMANAGER_SECTION);
+    optDontCareMinimization.addChoice("none", "keep leaves as they are", true);
+    optDontCareMinimization.addChoice("restrict", "generalized cofactor (Restrict)");
+    optDontCareMinimization.addChoice("licompaction", "leaf identifying compaction (LICompaction)");
+    optDontCareMinimization.addChoice("squeeze", "smallest BDD between the leaf restricted to and extended beyond the care set (Squeeze)");
+    app.getOptionHandler().addOption(optDontCareMinimization, NSFMANAGER_SECTION);
     app.getOptionHandler().addOption(optMaxGlobalNSFSize, NSFMANAGER_SECTION);
     app.getOptionHandler().addOption(optMaxBDDSize, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optMinBDDSize, NSFMANAGER_SECTION);
+    app.getOptionHandler().addOption(optAdaptiveBDDSize, NSFMANAGER_SECTION);
 #ifdef DEPQBF_ENABLED
     optDependencyScheme.addChoice("dynamic", "naive for 2-QBFs, standard for other instances", true);
-    optDependencyScheme.addChoice("standard", "standard dependency scheme");
+    optDependencyScheme.addChoice("standard", "standard dependency scheme (computed by DepQBF)");
+    optDependencyScheme.addChoice("standard-native", "standard dependency scheme (computed natively)");
     optDependencyScheme.addChoice("simple", "quantifier prefix");
     optDependencyScheme.addChoice("naive", "innermost variables");
 #endif
 #ifndef DEPQBF_ENABLED
     optDependencyScheme.addChoice("naive", "innermost variables", true);
     optDependencyScheme.addChoice("simple", "quantifier prefix");
+    optDependencyScheme.addChoice("standard-native", "standard dependency scheme (computed natively)");
 #endif    
     app.getOptionHandler().addOption(optDependencyScheme, NSFMANAGER_SECTION);
+    optRemoveCacheStrategy.addChoice("first", "first cached variable", true);
+    optRemoveCacheStrategy.addChoice("last", "last cached variable (LIFO)");
+    optRemoveCacheStrategy.addChoice("occurrences", "variable that occurs in the fewest leaves");
+    optRemoveCacheStrategy.addChoice("trial-split", "variable with the smallest cofactors of sampled leaves (Restrict)");
+    app.getOptionHandler().addOption(optRemoveCacheStrategy, NSFMANAGER_SECTION);
     app.getOptionHandler().addOption(optDisableCache, NSFMANAGER_SECTION);
     app.getOptionHandler().addOption(optPrintStats, NSFMANAGER_SECTION);
 }
@@ -71,13 +164,28 @@ ComputationManager::~ComputationManager() {
     if (depqbf != NULL) {
         qdpll_delete(depqbf);
     }
+#endif    
+    if (standardDependencyScheme != NULL) {
+        delete standardDependencyScheme;
+    }
     if (cuddToOriginalIds != NULL) {
         delete cuddToOriginalIds;
     }
-#endif    
+    if (notYetRemovedAtLevels != NULL) {
+        delete notYetRemovedAtLevels;
+    }
+    if (dependencyRelation != NULL) {
+        delete dependencyRelation;
+    }
+    if (vertexLevels != NULL) {
+        delete vertexLevels;
+    }
     if (variableCountAtLevels != NULL) {
         delete variableCountAtLevels;
     }
+    if (removeCacheStrategy != NULL) {
+        delete removeCacheStrategy;
+    }
     printStatistics();
 }
 
@@ -87,7 +195,7 @@ Computation* ComputationManager::newComputation(const std::vector<NTYPE>& quanti
         keepFirstLevel = app.enumerate() || app.modelCount();
     }
     if (keepFirstLevel) {
-        if (optUnsatCheckInterval.getValue() > 0 && quantifierSequence.size() >= 1 && quantifierSequence.at(0) == NTYPE::FORALL) {
+        if ((optUnsatCheckInterval.getValue() > 0 || optApproximationCheckInterval.getValue() > 0) && quantifierSequence.size() >= 1 && quantifierSequence.at(0) == NTYPE::FORALL) {
             throw std::runtime_error("Intermediate UNSAT checking must be disabled for enumeration and counting if outermost quantifier is universal");
         }
         if (optDisableCache.isUsed()) {
@@ -105,34 +213,32 @@ Computation* ComputationManager::newComputation(const std::vector<NTYPE>& quanti
         optMaxBDDSize.setValue("0");
         optDependencyScheme.setValue("naive");
     }
+    if (optAdaptiveBDDSize.isUsed() && (optDisableCache.isUsed() || optMinBDDSize.getValue() > optMaxBDDSize.getValue())) {
+        throw std::runtime_error("Adaptive split limit requires the removal cache and min-BDD-size not to exceed max-BDD-size");
+    }
+    if (useDontCareMinimization() && !optLazyClauses.isUsed()) {
+        throw std::runtime_error("Don't care minimization requires lazy clauses, which provide the care sets");
+    }
 
     
     
     Computation* c = NULL;
     
-#ifdef DEPQBF_ENABLED
-    if (optDependencyScheme.getValue() == "standard" || (optDependencyScheme.getValue() == "dynamic" && quantifierSequence.size() > 2)) {
-        if (depqbf == NULL) {
-            initializeDepqbf();
-        }
-        if (cuddToOriginalIds == NULL) {
-            initializeCuddToOriginalIds();
+    if (optDependencyScheme.getValue() == "standard" || optDependencyScheme.getValue() == "standard-native" || (optDependencyScheme.getValue() == "dynamic" && quantifierSequence.size() > 2)) {
+        if (notYetRemovedAtLevels == NULL) {
+            initializeStandardDependencyScheme();
         }
-        // always return a new vector
-        std::vector<std::set < htd::vertex_t>> notYetRemovedAtLevels = initializeNotYetRemovedAtLevels();
-
-        c = new StandardDependencyCacheComputation(*this, quantifierSequence, cubesAtLevels, bdd, optMaxBDDSize.getValue(), keepFirstLevel, *depqbf, *cuddToOriginalIds, notYetRemovedAtLevels);
+        c = new StandardDependencyCacheComputation(*this, quantifierSequence, cubesAtLevels, bdd, splitLimit(), keepFirstLevel, *cuddToOriginalIds, *notYetRemovedAtLevels);
     }
-#endif
     if (optDependencyScheme.getValue() == "simple") {
         if (variableCountAtLevels == NULL) {
             initializeVariableCountAtLevels();
         }
-        c = new SimpleDependencyCacheComputation(*this, quantifierSequence, cubesAtLevels, bdd, optMaxBDDSize.getValue(), keepFirstLevel, *variableCountAtLevels);
+        c = new SimpleDependencyCacheComputation(*this, quantifierSequence, cubesAtLevels, bdd, splitLimit(), keepFirstLevel, *variableCountAtLevels);
     } 
     if (c == NULL) {
         if (!optDisableCache.isUsed()) {
-            c = new CacheComputation(*this, quantifierSequence, cubesAtLevels, bdd, optMaxBDDSize.getValue(), keepFirstLevel);
+            c = new CacheComputation(*this, quantifierSequence, cubesAtLevels, bdd, splitLimit(), keepFirstLevel);
         } else {
             c = new Computation(*this, quantifierSequence, cubesAtLevels, bdd);
         }
@@ -146,7 +252,27 @@ Computation* ComputationManager::copyComputation(const Computation& c) {
     return nC;
 }
 
-void ComputationManager::apply(Computation& c, const std::vector<BDD>& cubesAtLevels, std::function<BDD(const BDD&)> f) {
+unsigned long ComputationManager::newComputationId() {
+    return nextComputationId++;
+}
+
+/**
+ * NSFs of 2-QBFs have depth one and are stored flat.
+ **/
+NSF* ComputationManager::newNSF(const std::vector<NTYPE>& quantifierSequence, const BDD& bdd) {
+    if (quantifierSequence.size() == 2) {
+        if (optSymbolicNSF.isUsed()) {
+            return new SymbolicNSF(nodeStore, *this, app.getBDDManager().getManager(), quantifierSequence, bdd);
+        }
+        return new FlatNSF(nodeStore, quantifierSequence, bdd);
+    }
+    if (optPackedNSF.isUsed()) {
+        return new PackedNSF(nodeStore, quantifierSequence, bdd);
+    }
+    return new NodeNSF(nodeStore, quantifierSequence, bdd);
+}
+
+void ComputationManager::apply(Computation& c, const std::vector<BDD>& cubesAtLevels, const std::function<BDD(const BDD&)>& f) {
     c.apply(cubesAtLevels, f);
     optimize(c);
 }
@@ -164,11 +290,11 @@ void ComputationManager::conjunct(Computation& c, Computation& other) {
 //    divideGlobalNSFSizeEstimation(c.leavesCount());
 //    divideGlobalNSFSizeEstimation(other.leavesCount());
     
-    if (optSortBeforeJoining.isUsed()) {
-        c.sortByIncreasingSize();
-        other.sortByIncreasingSize();
+    bool lazy = optLazyJoinSize.getValue() > -1 && (1.0 * oldLeavesCount1 * oldLeavesCount2) > optLazyJoinSize.getValue();
+    if (lazy) {
+        lazyJoinCount++;
     }
-    c.conjunct(other);
+    c.conjunct(other, lazy);
     divideGlobalNSFSizeEstimation(oldLeavesCount1);
     divideGlobalNSFSizeEstimation(oldLeavesCount2);
     multiplyGlobalNSFSizeEstimation(c.leavesCount());
@@ -205,24 +331,59 @@ void ComputationManager::removeApply(Computation& c, const std::vector<std::vect
 
 void ComputationManager::optimize(Computation &c) {
     updateStats(c);
+    if (useAdaptiveSplitLimit()) {
+        adaptSplitLimit(c);
+    }
     
     if (optUnsatCheckInterval.getValue() > 0) {
+        if (unsatCheckInterval == 0) {
+            unsatCheckInterval = optUnsatCheckInterval.getValue();
+            lastUnsatCheckClock = std::clock();
+        }
         optUnsatCheckCounter++;
-        optUnsatCheckCounter %= optUnsatCheckInterval.getValue();
+        optUnsatCheckCounter %= optAdaptiveIntervals.isUsed() ? unsatCheckInterval : optUnsatCheckInterval.getValue();
 
         if (optUnsatCheckCounter == 0) {
-            RESULT result = decide(c); 
+            std::clock_t begin = std::clock();
+            RESULT result = c.decideWithinBudget(optUnsatCheckBudget.getValue());
             if (result == RESULT::UNSAT) {
                 throw AbortException("Intermediate unsat check successful", RESULT::UNSAT);
             }
+            std::clock_t end = std::clock();
+            unsatCheckClock += end - begin;
+            if (optAdaptiveIntervals.isUsed()) {
+                // a check that does not abort never pays off
+                adaptInterval(unsatCheckInterval, optUnsatCheckInterval.getValue(), false, end - begin, begin - lastUnsatCheckClock, unsatCheckIntervalBackoffs, unsatCheckIntervalSpeedups);
+            }
+            lastUnsatCheckClock = end;
+        }
+    }
+
+    if (optApproximationCheckInterval.getValue() > 0) {
+        approximationCheckCounter++;
+        approximationCheckCounter %= optApproximationCheckInterval.getValue();
+
+        if (approximationCheckCounter == 0) {
+            approximationCheckCount++;
+            // further steps only conjoin, hence a false upper bound stays false
+            if (c.decideApproximation(overApproximation, true) == RESULT::UNSAT) {
+                approximationDecisionCount++;
+                throw AbortException("Intermediate approximation check successful", RESULT::UNSAT);
+            }
         }
     }
     
     if (optOptimizeInterval.getValue() > 0) {
+        if (optimizeInterval == 0) {
+            optimizeInterval = optOptimizeInterval.getValue();
+            lastOptimizeClock = std::clock();
+        }
         optIntervalCounter++;
-        optIntervalCounter %= optOptimizeInterval.getValue();
+        optIntervalCounter %= optAdaptiveIntervals.isUsed() ? optimizeInterval : optOptimizeInterval.getValue();
 
         if (optIntervalCounter == 0) {
+            std::clock_t begin = std::clock();
+            unsigned int initialLeavesCount = c.leavesCount();
             while ((maxGlobalNSFSizeEstimation < optMaxGlobalNSFSize.getValue()) || (optMaxGlobalNSFSize.getValue() <= -1)) {
                 unsigned int oldLeavesCount = c.leavesCount();
 //    divideGlobalNSFSizeEstimation(c.leavesCount());
@@ -233,16 +394,65 @@ void ComputationManager::optimize(Computation &c) {
                 divideGlobalNSFSizeEstimation(oldLeavesCount);
                 multiplyGlobalNSFSizeEstimation(c.leavesCount());
             }
+            std::clock_t end = std::clock();
+            optimizeClock += end - begin;
+            if (optAdaptiveIntervals.isUsed()) {
+                // compression pays off if it removes at least a tenth of the leaves
+                bool paidOff = c.leavesCount() * 10 <= initialLeavesCount * 9;
+                adaptInterval(optimizeInterval, optOptimizeInterval.getValue(), paidOff, end - begin, begin - lastOptimizeClock, optimizeIntervalBackoffs, optimizeIntervalSpeedups);
+            }
+            lastOptimizeClock = end;
         }
     }
+    if (useAdaptiveSplitLimit()) {
+        recordSplitLimitSizes(c);
+    }
     updateStats(c);
 }
 
+/**
+ * Halves interval (down to 1) after a check that paid off. Otherwise, the interval
+ * is doubled (up to 1024 times the configured one) if the check took more than a
+ * tenth of the time elapsed since the previous one, and it returns towards the
+ * configured interval if the check took less than a hundredth.
+ **/
+void ComputationManager::adaptInterval(unsigned int& interval, const unsigned int configured, const bool paidOff, const std::clock_t cost, const std::clock_t elapsed, unsigned int& backoffs, unsigned int& speedups) {
+    if (paidOff) {
+        if (interval > 1) {
+            interval /= 2;
+            speedups++;
+        }
+    } else if (cost * 10 > elapsed) {
+        if (interval < configured * 1024) {
+            interval *= 2;
+            backoffs++;
+        }
+    } else if (cost * 100 < elapsed && interval > configured) {
+        interval /= 2;
+        speedups++;
+    }
+}
+
 bool ComputationManager::isUnsat(const Computation& c) const {
     return c.isUnsat();
 }
 
+/**
+ * If approximation checks are enabled, bounds obtained from approximated leaves
+ * may decide without exact evaluation.
+ **/
 RESULT ComputationManager::decide(Computation& c) {
+    if (optApproximationCheckInterval.getValue() > 0) {
+        approximationCheckCount++;
+        if (c.decideApproximation(underApproximation, false) == RESULT::SAT) {
+            approximationDecisionCount++;
+            return RESULT::SAT;
+        }
+        if (c.decideApproximation(overApproximation, true) == RESULT::UNSAT) {
+            approximationDecisionCount++;
+            return RESULT::UNSAT;
+        }
+    }
     return c.decide();
 }
 
@@ -266,6 +476,139 @@ void ComputationManager::incrementSplitCount() {
     splitCount++;
 }
 
+void ComputationManager::addAvoidedSplitCopies(unsigned int count) {
+    avoidedSplitCopies += count;
+}
+
+void ComputationManager::addAbstractionBatch(unsigned int size) {
+    abstractionBatches++;
+    batchedAbstractions += size;
+}
+
+NSFNodeStore& ComputationManager::getNodeStore() {
+    return nodeStore;
+}
+
+/**
+ * Returns (at least) count index variables, new variables are created on demand.
+ **/
+const std::vector<BDD>& ComputationManager::indexVariables(unsigned int count) {
+    while (indexVariablePool.size() < count) {
+        indexVariablePool.push_back(app.getBDDManager().getManager().bddVar());
+    }
+    return indexVariablePool;
+}
+
+bool ComputationManager::useAntichainJoin() const {
+    return optAntichainJoin.isUsed();
+}
+
+bool ComputationManager::useLazyClauses() const {
+    return optLazyClauses.isUsed();
+}
+
+bool ComputationManager::useDontCareMinimization() const {
+    return optDontCareMinimization.getValue() != "none";
+}
+
+bool ComputationManager::useAdaptiveSplitLimit() const {
+    return optAdaptiveBDDSize.isUsed();
+}
+
+unsigned int ComputationManager::splitLimit() {
+    if (!optAdaptiveBDDSize.isUsed()) {
+        return optMaxBDDSize.getValue();
+    }
+    if (adaptedSplitLimit == 0) {
+        adaptedSplitLimit = optMaxBDDSize.getValue();
+    }
+    return adaptedSplitLimit;
+}
+
+/**
+ * Compares the growth of the maximum BDD size to the growth of the number of
+ * leaves during the step just performed on c, i.e. since the end of its
+ * previous step. The difference of both (on log scale) is smoothed over about
+ * eight steps. Splits trade BDD size for leaves: if BDDs keep growing faster
+ * (by more than about 5% per step), the limit is halved such that splits happen
+ * earlier, if leaves keep growing faster, it is doubled. Since every step is
+ * observed, a limit that is never reached is lowered as well.
+ **/
+void ComputationManager::adaptSplitLimit(const Computation& c) {
+    if (c.id() != splitLimitComputationId || splitLimitLeavesCount == 0 || splitLimitBDDsize == 0) {
+        return;
+    }
+    double leavesGrowth = std::log((double) std::max(c.leavesCount(), 1u) / splitLimitLeavesCount);
+    double bddGrowth = std::log((double) std::max(c.maxBDDsize(), 1u) / splitLimitBDDsize);
+    splitLimitTrend += (bddGrowth - leavesGrowth - splitLimitTrend) / 8;
+    unsigned int limit = splitLimit();
+    if (splitLimitTrend > 0.05 && limit > (unsigned int) optMinBDDSize.getValue()) {
+        adaptedSplitLimit = std::max(limit / 2, (unsigned int) optMinBDDSize.getValue());
+        splitLimitDecreases++;
+        splitLimitTrend = 0;
+    } else if (splitLimitTrend < -0.05 && limit < (unsigned int) optMaxBDDSize.getValue()) {
+        adaptedSplitLimit = std::min(2 * (unsigned long) limit, (unsigned long) optMaxBDDSize.getValue());
+        splitLimitIncreases++;
+        splitLimitTrend = 0;
+    }
+}
+
+/**
+ * Sizes of c after optimization, the growth of the next step is measured
+ * against them.
+ **/
+void ComputationManager::recordSplitLimitSizes(const Computation& c) {
+    splitLimitComputationId = c.id();
+    splitLimitLeavesCount = c.leavesCount();
+    splitLimitBDDsize = c.maxBDDsize();
+}
+
+const RemoveCacheStrategy& ComputationManager::getRemoveCacheStrategy() {
+    if (removeCacheStrategy == NULL) {
+        if (optRemoveCacheStrategy.getValue() == "last") {
+            removeCacheStrategy = new LastRemoveCacheStrategy();
+        } else if (optRemoveCacheStrategy.getValue() == "occurrences") {
+            removeCacheStrategy = new OccurrenceRemoveCacheStrategy();
+        } else if (optRemoveCacheStrategy.getValue() == "trial-split") {
+            removeCacheStrategy = new TrialSplitRemoveCacheStrategy();
+        } else {
+            removeCacheStrategy = new FirstRemoveCacheStrategy();
+        }
+    }
+    return *removeCacheStrategy;
+}
+
+void ComputationManager::countRemovalSelection(unsigned int candidates, unsigned int leavesCount, unsigned int maxBDDsize) {
+    removalSelections++;
+    removalCandidates += candidates;
+    removalLeavesBefore += leavesCount;
+    removalBDDsizeBefore += maxBDDsize;
+}
+
+void ComputationManager::addRemovalSelectionTime(std::clock_t time) {
+    removalSelectionClock += time;
+}
+
+/**
+ * Records the NSF after the removal of a selected variable and the subsequent optimization.
+ **/
+void ComputationManager::countRemovalResult(unsigned int leavesCount, unsigned int maxBDDsize) {
+    removalLeavesAfter += leavesCount;
+    removalBDDsizeAfter += maxBDDsize;
+}
+
+/**
+ * Returns a BDD that coincides with leaf wherever careSet holds.
+ **/
+BDD ComputationManager::minimize(const BDD& leaf, const BDD& careSet) const {
+    if (optDontCareMinimization.getValue() == "restrict") {
+        return leaf.Restrict(careSet);
+    } else if (optDontCareMinimization.getValue() == "licompaction") {
+        return leaf.LICompaction(careSet);
+    }
+    return (leaf * careSet).Squeeze(leaf + !careSet);
+}
+
 void ComputationManager::printStatistics() const {
     if (!optPrintStats.isUsed()) {
         return;
@@ -291,9 +634,50 @@ void ComputationManager::printStatistics() const {
     std::cout << "NSF (max domain size - cache size): " << maxDomainSizeCacheSize << std::endl;
     
     std::cout << "NSF (splits): " << splitCount << std::endl;
+    std::cout << "NSF (avoided split copies): " << avoidedSplitCopies << std::endl;
     std::cout << "NSF (abstractions): " << abstractCount << std::endl;
     std::cout << "NSF (internal abstractions): " << internalAbstractCount << std::endl;
+    std::cout << "NSF (abstraction batches): " << abstractionBatches << std::endl;
+    std::cout << "NSF (batched abstractions): " << batchedAbstractions << std::endl;
     std::cout << "NSF (shifts): " << shiftCount << std::endl;
+    std::cout << "NSF (lazy joins): " << lazyJoinCount << std::endl;
+    std::cout << "NSF (approximation checks): " << approximationCheckCount << std::endl;
+    std::cout << "NSF (approximation decisions): " << approximationDecisionCount << std::endl;
+
+    std::cout << std::fixed << "NSF (optimization time): " << double(optimizeClock) / CLOCKS_PER_SEC << std::endl;
+    std::cout << "NSF (optimization interval): " << (optAdaptiveIntervals.isUsed() ? optimizeInterval : optOptimizeInterval.getValue()) << std::endl;
+    std::cout << "NSF (optimization interval backoffs): " << optimizeIntervalBackoffs << std::endl;
+    std::cout << "NSF (optimization interval speedups): " << optimizeIntervalSpeedups << std::endl;
+    std::cout << std::fixed << "NSF (unsat check time): " << double(unsatCheckClock) / CLOCKS_PER_SEC << std::endl;
+    std::cout << "NSF (unsat check interval): " << (optAdaptiveIntervals.isUsed() ? unsatCheckInterval : optUnsatCheckInterval.getValue()) << std::endl;
+    std::cout << "NSF (unsat check interval backoffs): " << unsatCheckIntervalBackoffs << std::endl;
+    std::cout << "NSF (unsat check interval speedups): " << unsatCheckIntervalSpeedups << std::endl;
+    std::cout << "NSF (split limit): " << (optAdaptiveBDDSize.isUsed() ? adaptedSplitLimit : optMaxBDDSize.getValue()) << std::endl;
+    std::cout << "NSF (split limit decreases): " << splitLimitDecreases << std::endl;
+    std::cout << "NSF (split limit increases): " << splitLimitIncreases << std::endl;
+
+    std::cout << "NSF (removal strategy): " << optRemoveCacheStrategy.getValue() << std::endl;
+    std::cout << "NSF (removal selections): " << removalSelections << std::endl;
+    std::cout << "NSF (removal candidates): " << removalCandidates << std::endl;
+    std::cout << std::fixed << "NSF (removal selection time): " << double(removalSelectionClock) / CLOCKS_PER_SEC << std::endl;
+    std::cout << "NSF (removal leaves before): " << removalLeavesBefore << std::endl;
+    std::cout << "NSF (removal leaves after): " << removalLeavesAfter << std::endl;
+    std::cout << "NSF (removal max BDD size before): " << removalBDDsizeBefore << std::endl;
+    std::cout << "NSF (removal max BDD size after): " << removalBDDsizeAfter << std::endl;
+    std::cout << "NSF (index variables): " << indexVariablePool.size() << std::endl;
+
+    std::cout << "NSF (max unique nodes): " << nodeStore.maxSize() << std::endl;
+    std::cout << "NSF (unique node hits): " << nodeStore.hits() << std::endl;
+    std::cout << "NSF (node pool blocks): " << nodeStore.poolBlocks() << std::endl;
+
+    std::cout << "NSF (subset checks): " << nodeStore.subsetChecks() << std::endl;
+    std::cout << "NSF (subset checks filtered by signature): " << nodeStore.filteredSubsetChecks() << std::endl;
+    std::cout << "NSF (fused and-abstractions): " << nodeStore.fusedAbstractions() << std::endl;
+    std::cout << "NSF (fused and-abstraction leaf nodes before): " << nodeStore.fusedAbstractionNodesBefore() << std::endl;
+    std::cout << "NSF (fused and-abstraction leaf nodes after): " << nodeStore.fusedAbstractionNodesAfter() << std::endl;
+    std::cout << "NSF (don't care minimizations): " << nodeStore.minimizations() << std::endl;
+    std::cout << "NSF (don't care minimization leaf nodes before): " << nodeStore.minimizationNodesBefore() << std::endl;
+    std::cout << "NSF (don't care minimization leaf nodes after): " << nodeStore.minimizationNodesAfter() << std::endl;
 }
 
 void ComputationManager::divideGlobalNSFSizeEstimation(int value) {
@@ -401,6 +785,20 @@ void ComputationManager::initializeDepqbf() {
 
     qdpll_init_deps(depqbf);
 }
+#endif
+
+void ComputationManager::initializeStandardDependencyScheme() {
+    initializeCuddToOriginalIds();
+    initializeNotYetRemovedAtLevels();
+#ifdef DEPQBF_ENABLED
+    // standard and dynamic
+    if (optDependencyScheme.getValue() != "standard-native") {
+        initializeDepqbf();
+        return;
+    }
+#endif
+    standardDependencyScheme = new StandardDependencyScheme(*app.getInputInstance());
+}
 
 void ComputationManager::initializeCuddToOriginalIds() {
     std::vector<int> htdToCuddIds = app.getVertexOrdering();
@@ -413,20 +811,48 @@ void ComputationManager::initializeCuddToOriginalIds() {
     }
 }
 
-std::vector<std::set < htd::vertex_t >> ComputationManager::initializeNotYetRemovedAtLevels() {
-    std::vector<std::set < htd::vertex_t>> notYetRemovedAtLevels; // = new std::vector<std::set < htd::vertex_t >> ();
-
+void ComputationManager::initializeNotYetRemovedAtLevels() {
+    htd::vertex_t size = 1;
+    for (htd::vertex_t vertex : app.getInputInstance()->hypergraph->internalGraph().vertices()) {
+        if (vertex >= size) {
+            size = vertex + 1;
+        }
+    }
+    notYetRemovedAtLevels = new std::vector<VertexBitset>();
+    vertexLevels = new std::vector<unsigned int>(size, 0);
     for (htd::vertex_t vertex : app.getInputInstance()->hypergraph->internalGraph().vertices()) {
         unsigned int vertexLevel = htd::accessLabel<int>(app.getInputInstance()->hypergraph->internalGraph().vertexLabel("level", vertex));
-        while (notYetRemovedAtLevels.size() < vertexLevel) {
-            std::set<htd::vertex_t> notYetRemoved;
-            notYetRemovedAtLevels.push_back(notYetRemoved);
+        while (notYetRemovedAtLevels->size() < vertexLevel) {
+            notYetRemovedAtLevels->push_back(VertexBitset(size));
         }
-        notYetRemovedAtLevels.at(vertexLevel - 1).insert(vertex);
+        notYetRemovedAtLevels->at(vertexLevel - 1).insert(vertex);
+        vertexLevels->at(vertex) = vertexLevel;
     }
-    return notYetRemovedAtLevels;
+    dependencyRelation = new std::vector<VertexBitset>(size);
 }
+
+/**
+ * Variables of inner levels the given variable depends on, if DepQBF is used
+ * it is queried only once per pair of variables.
+ **/
+const VertexBitset& ComputationManager::dependencies(const htd::vertex_t vertex) {
+    VertexBitset& dependencies = dependencyRelation->at(vertex);
+    if (dependencies.size() == 0) {
+        dependencies = VertexBitset(vertexLevels->size());
+#ifdef DEPQBF_ENABLED
+        if (depqbf != NULL) {
+            for (htd::vertex_t other = 1; other < vertexLevels->size(); other++) {
+                if (vertexLevels->at(other) > vertexLevels->at(vertex) && qdpll_var_depends(depqbf, vertex, other)) {
+                    dependencies.insert(other);
+                }
+            }
+            return dependencies;
+        }
 #endif
+        standardDependencyScheme->addDependencies(vertex, dependencies);
+    }
+    return dependencies;
+}
 
 void ComputationManager::initializeVariableCountAtLevels() {
     variableCountAtLevels = new std::vector<unsigned int>();
@@ -22,6 +22,7 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <map>
+#include <ctime>
 
 #include <cuddObj.hh>
 
@@ -32,6 +33,10 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #include "../AbortException.h"
 #include "Computation.h"
 #include "CacheComputation.h"
+#include "NSFNodeStore.h"
+#include "RemoveCacheStrategy.h"
+#include "VertexBitset.h"
+#include "StandardDependencyScheme.h"
 #include "../Variable.h"
 
 #ifdef DEPQBF_ENABLED
@@ -50,8 +55,10 @@ public:
 
     Computation* newComputation(const std::vector<NTYPE>& quantifierSequence, const std::vector<BDD>& cubesAtLevels, const BDD& bdd);
     Computation* copyComputation(const Computation& c);
+    NSF* newNSF(const std::vector<NTYPE>& quantifierSequence, const BDD& bdd);
+    unsigned long newComputationId();
 
-    void apply(Computation& c, const std::vector<BDD>& cubesAtLevels, std::function<BDD(const BDD&)> f);
+    void apply(Computation& c, const std::vector<BDD>& cubesAtLevels, const std::function<BDD(const BDD&)>& f);
     void apply(Computation& c, const std::vector<BDD>& cubesAtLevels, const BDD& clauses);
 
     void conjunct(Computation& c, Computation& other);
@@ -71,6 +78,22 @@ public:
     void incrementShiftCount();
     
     void incrementSplitCount();
+    void addAvoidedSplitCopies(unsigned int count);
+    void addAbstractionBatch(unsigned int size);
+
+    NSFNodeStore& getNodeStore();
+    const std::vector<BDD>& indexVariables(unsigned int count);
+    bool useAntichainJoin() const;
+    bool useLazyClauses() const;
+    bool useDontCareMinimization() const;
+    bool useAdaptiveSplitLimit() const;
+    unsigned int splitLimit();
+    const RemoveCacheStrategy& getRemoveCacheStrategy();
+    void countRemovalSelection(unsigned int candidates, unsigned int leavesCount, unsigned int maxBDDsize);
+    void addRemovalSelectionTime(std::clock_t time);
+    void countRemovalResult(unsigned int leavesCount, unsigned int maxBDDsize);
+    BDD minimize(const BDD& leaf, const BDD& careSet) const;
+    const VertexBitset& dependencies(const htd::vertex_t vertex);
 
 protected:
 
@@ -83,16 +106,30 @@ private:
     void multiplyGlobalNSFSizeEstimation(int value);
     
     void updateStats(const Computation& c);
+    void adaptInterval(unsigned int& interval, const unsigned int configured, const bool paidOff, const std::clock_t cost, const std::clock_t elapsed, unsigned int& backoffs, unsigned int& speedups);
+    void adaptSplitLimit(const Computation& c);
+    void recordSplitLimitSizes(const Computation& c);
 
     static const std::string NSFMANAGER_SECTION;
 
     options::Option optPrintStats;
     options::DefaultIntegerValueOption optMaxGlobalNSFSize;
     options::DefaultIntegerValueOption optMaxBDDSize;
+    options::DefaultIntegerValueOption optMinBDDSize;
+    options::Option optAdaptiveBDDSize;
     options::DefaultIntegerValueOption optOptimizeInterval;
     options::DefaultIntegerValueOption optUnsatCheckInterval;
-    options::Option optSortBeforeJoining;
+    options::DefaultIntegerValueOption optUnsatCheckBudget;
+    options::DefaultIntegerValueOption optApproximationCheckInterval;
+    options::DefaultIntegerValueOption optLazyJoinSize;
+    options::Option optAdaptiveIntervals;
+    options::Option optAntichainJoin;
+    options::Option optPackedNSF;
+    options::Option optSymbolicNSF;
+    options::Option optLazyClauses;
+    options::Choice optDontCareMinimization;
     options::Choice optDependencyScheme;
+    options::Choice optRemoveCacheStrategy;
     options::Option optDisableCache;
 
     double maxGlobalNSFSizeEstimation;
@@ -101,15 +138,51 @@ private:
     bool left = true;
 
     unsigned int optUnsatCheckCounter;
+
+    // split limit of new and optimized computations if it is adapted (0 until first use)
+    unsigned int adaptedSplitLimit;
+    // id of the computation last seen by adaptSplitLimit (0 for none) and its sizes at the end of its previous step
+    unsigned long splitLimitComputationId;
+    unsigned int splitLimitLeavesCount;
+    unsigned int splitLimitBDDsize;
+    // smoothed per-step growth of the maximum BDD size relative to the number of leaves (log scale)
+    double splitLimitTrend;
+
+    // intervals used instead of the configured ones if they are adapted (0 until first use)
+    unsigned int optimizeInterval;
+    unsigned int unsatCheckInterval;
+    std::clock_t lastOptimizeClock;
+    std::clock_t lastUnsatCheckClock;
+
+    unsigned int approximationCheckCounter;
+
+    // ids are never reused, unlike addresses of deleted computations
+    unsigned long nextComputationId;
+
+    // hash-consed NSF nodes of all computations
+    NSFNodeStore nodeStore;
+
+    // selects variables to remove from remove caches (created on first use)
+    RemoveCacheStrategy* removeCacheStrategy;
+
+    // auxiliary variables for SymbolicNSFs
+    std::vector<BDD> indexVariablePool;
     
-    // for standard depencency scheme handling (provided by DepQBF)
+    // for standard depencency scheme handling (native or provided by DepQBF)
+    void initializeStandardDependencyScheme();
+    void initializeCuddToOriginalIds();
+    void initializeNotYetRemovedAtLevels();
+    StandardDependencyScheme* standardDependencyScheme = NULL;
 #ifdef DEPQBF_ENABLED
     void initializeDepqbf();
-    void initializeCuddToOriginalIds();
-    std::vector<std::set < htd::vertex_t>> initializeNotYetRemovedAtLevels();
     QDPLL* depqbf = NULL;
-    std::vector<unsigned int>* cuddToOriginalIds;
 #endif
+    std::vector<unsigned int>* cuddToOriginalIds = NULL;
+    // variables of each level, copied into every new computation
+    std::vector<VertexBitset>* notYetRemovedAtLevels = NULL;
+    // dependencies on variables of inner levels, each is computed on first use
+    std::vector<VertexBitset>* dependencyRelation = NULL;
+    std::vector<unsigned int>* vertexLevels = NULL;
     
     // for simple dependency scheme handling
     void initializeVariableCountAtLevels();
@@ -122,6 +195,29 @@ private:
     unsigned int abstractCount;
     
     unsigned int splitCount;
+    unsigned int lazyJoinCount;
+    unsigned int avoidedSplitCopies;
+    unsigned int abstractionBatches;
+    unsigned int batchedAbstractions;
+    unsigned int approximationCheckCount;
+    unsigned int approximationDecisionCount;
+
+    std::clock_t optimizeClock;
+    std::clock_t unsatCheckClock;
+    unsigned int optimizeIntervalBackoffs;
+    unsigned int optimizeIntervalSpeedups;
+    unsigned int unsatCheckIntervalBackoffs;
+    unsigned int unsatCheckIntervalSpeedups;
+    unsigned int splitLimitDecreases;
+    unsigned int splitLimitIncreases;
+
+    unsigned int removalSelections;
+    unsigned long removalCandidates;
+    std::clock_t removalSelectionClock;
+    unsigned long removalLeavesBefore;
+    unsigned long removalLeavesAfter;
+    unsigned long removalBDDsizeBefore;
+    unsigned long removalBDDsizeAfter;
     
     unsigned int maxNSFsize;
     unsigned int maxNSFsizeBDDsize;
@@ -0,0 +1,394 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <iostream>
+#include <algorithm>
+
+#include "FlatNSF.h"
+
+namespace {
+
+    bool nodeOrder(const BDD& b1, const BDD& b2) {
+        return b1.getNode() < b2.getNode();
+    }
+}
+
+FlatNSF::FlatNSF(NSFNodeStore& store, const std::vector<NTYPE>& quantifierSequence, const BDD& bdd) :
+_store(store),
+_outerQuantifier(quantifierSequence.at(0)),
+_innerQuantifier(quantifierSequence.at(1)),
+_nestedSet(1, bdd),
+_sizesValid(false) {
+}
+
+FlatNSF::FlatNSF(const FlatNSF& other) :
+_store(other._store),
+_outerQuantifier(other._outerQuantifier),
+_innerQuantifier(other._innerQuantifier),
+_nestedSet(other._nestedSet),
+_sizes(other._sizes),
+_bySize(other._bySize),
+_sizesValid(other._sizesValid) {
+}
+
+FlatNSF::~FlatNSF() {
+}
+
+NSF* FlatNSF::copy() const {
+    return new FlatNSF(*this);
+}
+
+bool FlatNSF::operator==(const NSF& other) const {
+    const FlatNSF* o = dynamic_cast<const FlatNSF*> (&other);
+    return o != NULL && _nestedSet == o->_nestedSet;
+}
+
+bool FlatNSF::operator!=(const NSF& other) const {
+    return !(*this == other);
+}
+
+bool FlatNSF::operator<=(const NSF& other) const {
+    const FlatNSF& o = dynamic_cast<const FlatNSF&> (other);
+    return std::includes(o._nestedSet.begin(), o._nestedSet.end(), _nestedSet.begin(), _nestedSet.end(), nodeOrder);
+}
+
+unsigned int FlatNSF::depth() const {
+    return 1;
+}
+
+unsigned int FlatNSF::level() const {
+    return 1;
+}
+
+NTYPE FlatNSF::quantifier() const {
+    return _outerQuantifier;
+}
+
+const unsigned int FlatNSF::maxBDDsize() const {
+    sortBySize();
+    return _sizes[_bySize.back()];
+}
+
+const unsigned int FlatNSF::leavesCount() const {
+    return _nestedSet.size();
+}
+
+const unsigned int FlatNSF::nsfCount() const {
+    return _nestedSet.size() + 1;
+}
+
+void FlatNSF::print(bool verbose) const {
+    if (verbose) {
+        std::cout << (_outerQuantifier == NTYPE::EXISTS ? "E" : "A") << " l1 d1 ";
+    }
+    std::cout << "{";
+    for (const BDD& b : _nestedSet) {
+        if (verbose) {
+            std::cout << (_innerQuantifier == NTYPE::EXISTS ? "E" : "A") << " l2 d0 ";
+        }
+        if (b.IsZero()) {
+            std::cout << "[B]";
+        } else if (b.IsOne()) {
+            std::cout << "[T]";
+        } else {
+            std::cout << "[" << b.nodeCount() << "]";
+            if (verbose) {
+                std::cout << std::endl;
+                b.print(0, 2);
+                std::cout << std::endl;
+            }
+        }
+    }
+    std::cout << "}";
+}
+
+void FlatNSF::apply(const std::function<BDD(const BDD&)>& f) {
+    for (BDD& b : _nestedSet) {
+        b = f(b);
+    }
+    normalize();
+}
+
+void FlatNSF::apply(const BDD& clauses) {
+    for (BDD& b : _nestedSet) {
+        b *= clauses;
+    }
+    normalize();
+}
+
+/**
+ * Leaves are explicit, hence clauses are applied right away.
+ **/
+void FlatNSF::applyLazily(const BDD& clauses) {
+    apply(clauses);
+}
+
+/**
+ * Same as NodeNSF::applyAbstract, existential abstraction is fused via AndAbstract
+ * and universal abstraction distributes over the conjunction.
+ **/
+void FlatNSF::applyAbstract(const BDD& clauses, const BDD& cube, const unsigned int vl) {
+    NTYPE quantifier = (vl == 1) ? _outerQuantifier : _innerQuantifier;
+    BDD abstractedClauses;
+    if (quantifier == NTYPE::FORALL) {
+        abstractedClauses = clauses.UnivAbstract(cube);
+    }
+    unsigned long nodesBefore = 0;
+    unsigned long nodesAfter = 0;
+    for (BDD& b : _nestedSet) {
+        nodesBefore += b.nodeCount();
+        if (quantifier == NTYPE::EXISTS) {
+            b = b.AndAbstract(clauses, cube, 0);
+        } else {
+            b = b.UnivAbstract(cube) * abstractedClauses;
+        }
+        nodesAfter += b.nodeCount();
+    }
+    _store.countFusedAbstraction(nodesBefore, nodesAfter);
+    normalize();
+}
+
+void FlatNSF::conjunct(const NSF& other, bool antichain) {
+    const FlatNSF& o = dynamic_cast<const FlatNSF&> (other);
+    std::vector<BDD> nestedSet;
+    if (!antichain) {
+        nestedSet.reserve(_nestedSet.size() * o._nestedSet.size());
+    }
+    for (const BDD& b1 : _nestedSet) {
+        for (const BDD& b2 : o._nestedSet) {
+            if (antichain) {
+                insertIntoAntichain(nestedSet, b1 * b2);
+            } else {
+                nestedSet.push_back(b1 * b2);
+            }
+        }
+    }
+    _nestedSet.swap(nestedSet);
+    normalize();
+}
+
+/**
+ * Products of depth one are cheap to build, hence they are never deferred.
+ **/
+void FlatNSF::conjunctLazily(const NSF& other, bool antichain) {
+    conjunct(other, antichain);
+}
+
+bool FlatNSF::hasPendingProduct() const {
+    return false;
+}
+
+void FlatNSF::removeAbstract(const BDD& variable, const unsigned int vl) {
+    NTYPE quantifier = (vl == 1) ? _outerQuantifier : _innerQuantifier;
+    for (BDD& b : _nestedSet) {
+        b = abstract(b, variable, quantifier);
+    }
+    normalize();
+}
+
+/**
+ * Variables of the outer block split the nested set, where only leaves
+ * with different cofactors are duplicated.
+ **/
+unsigned int FlatNSF::remove(const BDD& variable, const unsigned int vl) {
+    unsigned int avoidedCopies = 0;
+    if (vl == 1) {
+        BDD negatedVariable = !variable;
+        std::vector<BDD> nestedSet;
+        nestedSet.reserve(_nestedSet.size() * 2);
+        for (const BDD& b : _nestedSet) {
+            BDD positive = b.Restrict(variable);
+            BDD negative = b.Restrict(negatedVariable);
+            nestedSet.push_back(positive);
+            if (negative == positive) {
+                avoidedCopies++;
+            } else {
+                nestedSet.push_back(negative);
+            }
+        }
+        _nestedSet.swap(nestedSet);
+    } else {
+        for (BDD& b : _nestedSet) {
+            b = abstract(b, variable, _innerQuantifier);
+        }
+    }
+    normalize();
+    return avoidedCopies;
+}
+
+BDD FlatNSF::truncate(const std::vector<BDD>& cubesAtlevels) {
+    BDD ret = abstract(_nestedSet.front(), cubesAtlevels[1], _innerQuantifier);
+    for (unsigned int it = 1; it < _nestedSet.size(); it++) {
+        if (_outerQuantifier == NTYPE::EXISTS) {
+            ret += abstract(_nestedSet.at(it), cubesAtlevels[1], _innerQuantifier);
+        } else {
+            ret *= abstract(_nestedSet.at(it), cubesAtlevels[1], _innerQuantifier);
+        }
+    }
+    return abstract(ret, cubesAtlevels[0], _outerQuantifier);
+}
+
+/**
+ * Leaves are evaluated by increasing BDD size, such that small leaves that
+ * decide the result spare the abstraction of large ones.
+ **/
+const BDD FlatNSF::evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) {
+    sortBySize();
+    unsigned long cost = 0;
+    withinBudget = true;
+    BDD ret;
+    bool first = true;
+    for (unsigned int index : _bySize) {
+        const BDD& b = _nestedSet[index];
+        if (budget > 0) {
+            cost += _sizes[index];
+            if (cost > budget) {
+                withinBudget = false;
+                return ret;
+            }
+        }
+        BDD value = abstract(b, cubesAtlevels[1], _innerQuantifier);
+        if (!keepFirstLevel) {
+            value = abstract(value, cubesAtlevels[0], _outerQuantifier);
+        }
+        if (_outerQuantifier == NTYPE::EXISTS) {
+            ret = first ? value : ret + value;
+            if (ret.IsOne()) {
+                break;
+            }
+        } else {
+            ret = first ? value : ret * value;
+            if (ret.IsZero()) {
+                break;
+            }
+        }
+        first = false;
+    }
+    return ret;
+}
+
+bool FlatNSF::isUnsat() const {
+    for (const BDD& b : _nestedSet) {
+        bool unsatC = b.IsZero();
+        if (_outerQuantifier == NTYPE::EXISTS && !unsatC) {
+            return false;
+        } else if (_outerQuantifier == NTYPE::FORALL && unsatC) {
+            return true;
+        }
+    }
+    return _outerQuantifier == NTYPE::EXISTS;
+}
+
+std::vector<BDD> FlatNSF::leavesDependingOn(const BDD& variable, const unsigned int limit) const {
+    std::vector<BDD> leaves;
+    for (const BDD& b : _nestedSet) {
+        if (limit > 0 && leaves.size() >= limit) {
+            break;
+        }
+        if (b.Support() <= variable) {
+            leaves.push_back(b);
+        }
+    }
+    return leaves;
+}
+
+unsigned int FlatNSF::countLeavesDependingOn(const BDD& variable) const {
+    unsigned int count = 0;
+    for (const BDD& b : _nestedSet) {
+        if (b.Support() <= variable) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool FlatNSF::optimize() {
+    std::vector<BDD> nestedSet;
+    nestedSet.reserve(_nestedSet.size());
+    for (const BDD& b : _nestedSet) {
+        insertIntoAntichain(nestedSet, b);
+    }
+    bool compressed = nestedSet.size() < _nestedSet.size();
+    _nestedSet.swap(nestedSet);
+    normalize();
+    return compressed;
+}
+
+/**
+ * The nested set is compressed completely in both directions.
+ **/
+bool FlatNSF::optimize(bool left) {
+    return optimize();
+}
+
+BDD FlatNSF::abstract(const BDD& bdd, const BDD& cube, const NTYPE quantifier) const {
+    if (quantifier == NTYPE::EXISTS) {
+        return bdd.ExistAbstract(cube, 0);
+    } else {
+        return bdd.UnivAbstract(cube);
+    }
+}
+
+void FlatNSF::normalize() {
+    std::sort(_nestedSet.begin(), _nestedSet.end(), nodeOrder);
+    _nestedSet.erase(std::unique(_nestedSet.begin(), _nestedSet.end()), _nestedSet.end());
+    _sizesValid = false;
+}
+
+void FlatNSF::sortBySize() const {
+    if (_sizesValid) {
+        return;
+    }
+    _sizes.clear();
+    _bySize.clear();
+    for (unsigned int index = 0; index < _nestedSet.size(); index++) {
+        _sizes.push_back(_nestedSet[index].nodeCount());
+        _bySize.push_back(index);
+    }
+    std::sort(_bySize.begin(), _bySize.end(), [this](unsigned int i1, unsigned int i2) -> bool {
+        return _sizes[i1] < _sizes[i2];
+    });
+    _sizesValid = true;
+}
+
+bool FlatNSF::isSubset(const BDD& b1, const BDD& b2) const {
+    bool filtered = !(b1.IsZero() || b2.IsOne()) && (b1.IsOne() || b2.IsZero());
+    _store.countSubsetCheck(filtered);
+    return !filtered && b1 <= b2;
+}
+
+/**
+ * Subsumption follows NodeNSF::compressConjunctive for nested sets of depth one.
+ **/
+bool FlatNSF::insertIntoAntichain(std::vector<BDD>& nestedSet, const BDD& bdd) const {
+    bool keepSubsets = _outerQuantifier == NTYPE::FORALL;
+    for (const BDD& b : nestedSet) {
+        if (keepSubsets ? isSubset(b, bdd) : isSubset(bdd, b)) {
+            return false;
+        }
+    }
+    std::vector<BDD>::iterator end = std::remove_if(nestedSet.begin(), nestedSet.end(), [&](const BDD & b) -> bool {
+        return keepSubsets ? isSubset(bdd, b) : isSubset(b, bdd);
+    });
+    nestedSet.erase(end, nestedSet.end());
+    nestedSet.push_back(bdd);
+    return true;
+}
@@ -0,0 +1,99 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "NSF.h"
+#include "NSFNodeStore.h"
+
+/**
+ * NSF for quantifier prefixes with two blocks.
+ * 
+ * Such NSFs always have depth one, hence the nested set is stored as a flat
+ * vector of leaf BDDs (ordered by DdNode and without duplicates) and all
+ * operations are plain loops over it. Leaf sizes and the order of the leaves by
+ * size are computed on first use after a change.
+ **/
+class FlatNSF : public NSF {
+public:
+    FlatNSF(NSFNodeStore& store, const std::vector<NTYPE>& quantifierSequence, const BDD& bdd);
+    FlatNSF(const FlatNSF& other);
+    virtual ~FlatNSF();
+
+    virtual NSF* copy() const override;
+
+    virtual bool operator==(const NSF& other) const override;
+    virtual bool operator!=(const NSF& other) const override;
+    virtual bool operator<=(const NSF& other) const override;
+
+    virtual unsigned int depth() const override;
+    virtual unsigned int level() const override;
+    virtual NTYPE quantifier() const override;
+
+    virtual const unsigned int maxBDDsize() const override;
+    virtual const unsigned int leavesCount() const override;
+    virtual const unsigned int nsfCount() const override;
+
+    virtual void print(bool verbose = false) const override;
+
+    virtual void apply(const std::function<BDD(const BDD&)>& f) override;
+    virtual void apply(const BDD& clauses) override;
+    virtual void applyLazily(const BDD& clauses) override;
+    virtual void applyAbstract(const BDD& clauses, const BDD& cube, const unsigned int vl) override;
+
+    virtual void conjunct(const NSF& other, bool antichain) override;
+    virtual void conjunctLazily(const NSF& other, bool antichain) override;
+    virtual bool hasPendingProduct() const override;
+
+    virtual void removeAbstract(const BDD& variable, const unsigned int vl) override;
+
+    using NSF::remove;
+    virtual unsigned int remove(const BDD& variable, const unsigned int vl) override;
+
+    virtual BDD truncate(const std::vector<BDD>& cubesAtlevels) override;
+    using NSF::evaluate;
+    virtual const BDD evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) override;
+    virtual bool isUnsat() const override;
+    virtual std::vector<BDD> leavesDependingOn(const BDD& variable, const unsigned int limit) const override;
+    virtual unsigned int countLeavesDependingOn(const BDD& variable) const override;
+
+    virtual bool optimize() override;
+    virtual bool optimize(bool left) override;
+
+private:
+    BDD abstract(const BDD& bdd, const BDD& cube, const NTYPE quantifier) const;
+    void normalize();
+    void sortBySize() const;
+    bool isSubset(const BDD& b1, const BDD& b2) const;
+    bool insertIntoAntichain(std::vector<BDD>& nestedSet, const BDD& bdd) const;
+
+    NSFNodeStore& _store;
+    NTYPE _outerQuantifier;
+    NTYPE _innerQuantifier;
+    std::vector<BDD> _nestedSet;
+
+    // BDD sizes of the leaves and their positions by increasing size
+    mutable std::vector<unsigned int> _sizes;
+    mutable std::vector<unsigned int> _bySize;
+    mutable bool _sizesValid;
+};
@@ -24,6 +24,7 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #include <iostream>
 #include <set>
 #include <list>
+#include <map>
 #include <functional>
 
 #include "cuddObj.hh"
@@ -32,69 +33,56 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #include "../BDDManager.h"
 #include "../Instance.h"
 
+/**
+ * Nested set of formulas, as used by computations.
+ *
+ * NSFs of different representations (see NodeNSF, FlatNSF, SymbolicNSF) are
+ * never mixed, binary operations expect other to be of the same type.
+ **/
 class NSF {
 public:
-    ~NSF();
+    virtual ~NSF();
 
-    NSF(const NSF& other);
-    NSF(unsigned int level, unsigned int depth, NTYPE type); // TODO: should not be public
+    virtual NSF* copy() const = 0;
 
-    bool operator==(const NSF& other) const;
-    bool operator!=(const NSF& other) const;
-    bool operator<=(const NSF& other) const;
+    virtual bool operator==(const NSF& other) const = 0;
+    virtual bool operator!=(const NSF& other) const = 0;
+    virtual bool operator<=(const NSF& other) const = 0;
 
-    const BDD& value() const;
-    void setValue(const BDD& bdd);
+    virtual unsigned int depth() const = 0;
+    virtual unsigned int level() const = 0;
+    virtual NTYPE quantifier() const = 0;
 
-    const std::vector<NSF *>& nestedSet() const;
-    void insertNSF(NSF * nsf);
-    void removeNSF(NSF * nsf);
+    virtual const unsigned int maxBDDsize() const = 0;
+    virtual const unsigned int leavesCount() const = 0;
+    virtual const unsigned int nsfCount() const = 0;
 
-    unsigned int depth() const;
-    unsigned int level() const;
-    NTYPE quantifier() const;
-    bool isLeaf() const;
-    bool isExistentiallyQuantified() const;
-    bool isUniversiallyQuantified() const;
+    virtual void print(bool verbose = false) const = 0;
 
-    const unsigned int maxBDDsize() const;
-    const unsigned int leavesCount() const;
-    const unsigned int nsfCount() const;
+    virtual void apply(const std::function<BDD(const BDD&)>& f) = 0;
+    virtual void apply(const BDD& clauses) = 0;
+    virtual void applyLazily(const BDD& clauses) = 0;
+    virtual void applyAbstract(const BDD& clauses, const BDD& cube, const unsigned int vl) = 0;
 
-    void print(bool verbose = false) const;
+    virtual void conjunct(const NSF& other, bool antichain) = 0;
+    virtual void conjunctLazily(const NSF& other, bool antichain) = 0;
+    virtual bool hasPendingProduct() const = 0;
 
-    void apply(std::function<BDD(const BDD&)> f);
-    void apply(const BDD& clauses);
+    virtual void removeAbstract(const BDD& variable, const unsigned int vl) = 0;
 
-    void conjunct(const NSF& other);
-
-    void removeAbstract(const BDD& variable, const unsigned int vl);
-    
-    void remove(const BDD& variable, const unsigned int vl);
-    void remove(const std::vector<std::vector<BDD>>&removedVertices);
+    virtual unsigned int remove(const BDD& variable, const unsigned int vl) = 0;
+    virtual unsigned int remove(const std::vector<std::vector<BDD>>&removedVertices);
 
     // deprecated
-    BDD truncate(const std::vector<BDD>& cubesAtlevels);
-    const BDD evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel);
-    bool isUnsat() const;
-
-    bool optimize();
-    bool optimize(bool left);
-    
-    void sortByIncreasingSize();
-
-protected:
-
-    int compressConjunctive();
-    int compressConjunctiveLeft();
-    int compressConjunctiveRight();
-
-private:
-    unsigned int _level;
-    unsigned int _depth;
-    NTYPE _type;
-    BDD _value;
-    std::vector<NSF *> _nestedSet;
+    virtual BDD truncate(const std::vector<BDD>& cubesAtlevels) = 0;
+    virtual const BDD evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel);
+    virtual const BDD evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) = 0;
+    virtual const BDD evaluateApproximation(const std::vector<BDD>& cubesAtlevels, const std::function<BDD(const BDD&)>& approximate, const bool upperBound, bool& bounded);
+    virtual bool isUnsat() const = 0;
+    virtual std::vector<BDD> leavesDependingOn(const BDD& variable, const unsigned int limit) const = 0;
+    virtual unsigned int countLeavesDependingOn(const BDD& variable) const = 0;
+
+    virtual bool optimize() = 0;
+    virtual bool optimize(bool left) = 0;
+    virtual void minimize(const std::function<BDD(const BDD&, const BDD&)>& minimizer);
 };
-
-
@@ -0,0 +1,326 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <iostream>
+#include <functional>
+
+#include "NSFNode.h"
+
+namespace {
+
+    // splitmix64 finalizer
+    inline uint64_t mix(uint64_t h) {
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+}
+
+NSFNode::NSFNode(unsigned int level, unsigned int depth, NTYPE type, const BDD& value) :
+_id(0),
+_references(0),
+_level(level),
+_depth(depth),
+_type(type),
+_value(value),
+_nestedSet(),
+_leavesCount(0),
+_nsfCount(0),
+_maxBDDsize(0),
+_maxBDDsizeValid(false),
+_support(),
+_supportValid(false) {
+    computeFingerprint();
+    computeSignature();
+    computeAggregates();
+}
+
+NSFNode::NSFNode(unsigned int level, unsigned int depth, NTYPE type, std::vector<const NSFNode*>& nestedSet) :
+_id(0),
+_references(0),
+_level(level),
+_depth(depth),
+_type(type),
+_nestedSet(),
+_leavesCount(0),
+_nsfCount(0),
+_maxBDDsize(0),
+_maxBDDsizeValid(false),
+_support(),
+_supportValid(false) {
+    _nestedSet.swap(nestedSet);
+    computeFingerprint();
+    computeSignature();
+    computeAggregates();
+}
+
+const BDD& NSFNode::value() const {
+    return _value;
+}
+
+const std::vector<const NSFNode *>& NSFNode::nestedSet() const {
+    return _nestedSet;
+}
+
+unsigned long NSFNode::id() const {
+    return _id;
+}
+
+uint64_t NSFNode::fingerprint() const {
+    return _fingerprint;
+}
+
+uint64_t NSFNode::signature() const {
+    return _signature;
+}
+
+unsigned int NSFNode::depth() const {
+    return _depth;
+}
+
+unsigned int NSFNode::level() const {
+    return _level;
+}
+
+NTYPE NSFNode::quantifier() const {
+    return _type;
+}
+
+bool NSFNode::isLeaf() const {
+    return _depth == 0;
+}
+
+bool NSFNode::isExistentiallyQuantified() const {
+    return _type == NTYPE::EXISTS;
+}
+
+bool NSFNode::isUniversiallyQuantified() const {
+    return _type == NTYPE::FORALL;
+}
+
+size_t NSFNode::hash() const {
+    return _fingerprint;
+}
+
+bool NSFNode::sameStructure(const NSFNode& other) const {
+    if (_fingerprint != other._fingerprint) {
+        return false;
+    }
+    if (_level != other._level || _depth != other._depth || _type != other._type) {
+        return false;
+    }
+    if (isLeaf()) {
+        return _value.getNode() == other._value.getNode();
+    }
+    // children are unique, so pointer comparison suffices
+    return _nestedSet == other._nestedSet;
+}
+
+bool NSFNode::fingerprintOrder(const NSFNode* n1, const NSFNode* n2) {
+    if (n1->_fingerprint != n2->_fingerprint) {
+        return n1->_fingerprint < n2->_fingerprint;
+    }
+    return n1->_id < n2->_id;
+}
+
+/**
+ * Nested sets are ordered by fingerprint, hence the fingerprint of a nested set
+ * is computed from the ordered child fingerprints.
+ **/
+void NSFNode::computeFingerprint() {
+    uint64_t h = mix((((uint64_t) _level) << 32) ^ (((uint64_t) _depth) << 8) ^ _type);
+    if (isLeaf()) {
+        h = mix(h ^ (uint64_t) (uintptr_t) _value.getNode());
+    } else {
+        for (const NSFNode* n : _nestedSet) {
+            h = mix(h ^ n->_fingerprint);
+        }
+    }
+    _fingerprint = h;
+}
+
+void NSFNode::computeAggregates() {
+    if (isLeaf()) {
+        _leavesCount = 1;
+        _nsfCount = 1;
+    } else {
+        _leavesCount = 0;
+        _nsfCount = 1;
+        for (const NSFNode* cC : _nestedSet) {
+            _leavesCount += cC->_leavesCount;
+            _nsfCount += cC->_nsfCount;
+        }
+    }
+}
+
+/**
+ * Each child sets one bit, so a nested set can only be contained in
+ * another one if its signature bits are a subset of the other's bits.
+ **/
+void NSFNode::computeSignature() {
+    _signature = 0;
+    if (isLeaf()) {
+        _signature = ((uint64_t) 1) << (_fingerprint & 63);
+    } else {
+        for (const NSFNode* n : _nestedSet) {
+            _signature |= ((uint64_t) 1) << (n->_fingerprint & 63);
+        }
+    }
+}
+
+/**
+ * Both nested sets are ordered by fingerprint, hence containment is a merge
+ * scan that stops as soon as a child of this cannot occur in other.
+ **/
+bool NSFNode::operator<=(const NSFNode& other) const {
+    if (this == &other) {
+        return true;
+    }
+    if (isLeaf()) {
+        return value() <= other.value();
+    }
+    if (_nestedSet.size() > other._nestedSet.size()) {
+        return false;
+    }
+    std::vector<const NSFNode*>::const_iterator it1 = _nestedSet.begin();
+    std::vector<const NSFNode*>::const_iterator end1 = _nestedSet.end();
+    std::vector<const NSFNode*>::const_iterator it2 = other._nestedSet.begin();
+    std::vector<const NSFNode*>::const_iterator end2 = other._nestedSet.end();
+    for (; it1 != end1; it1++) {
+        while (it2 != end2 && fingerprintOrder(*it2, *it1)) {
+            it2++;
+        }
+        if (it2 == end2 || *it2 != *it1) {
+            return false;
+        }
+        it2++;
+        if ((end2 - it2) < (end1 - it1 - 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Cheap necessary condition for (*this <= other).
+ * If false is returned, containment is impossible.
+ **/
+bool NSFNode::maybeSubsetOf(const NSFNode& other) const {
+    if (isLeaf()) {
+        if (_value.IsZero() || other._value.IsOne()) {
+            return true;
+        }
+        return !(_value.IsOne() || other._value.IsZero());
+    }
+    if (_nestedSet.size() > other._nestedSet.size()) {
+        return false;
+    }
+    return (_signature & ~other._signature) == 0;
+}
+
+const unsigned int NSFNode::maxBDDsize() const {
+    if (!_maxBDDsizeValid) {
+        if (isLeaf()) {
+            _maxBDDsize = _value.nodeCount();
+        } else {
+            _maxBDDsize = 0;
+            for (const NSFNode* childComp : _nestedSet) {
+                unsigned int size = childComp->maxBDDsize();
+                if (size > _maxBDDsize) {
+                    _maxBDDsize = size;
+                }
+            }
+        }
+        _maxBDDsizeValid = true;
+    }
+    return _maxBDDsize;
+}
+
+const BDD& NSFNode::support() const {
+    if (!_supportValid) {
+        if (isLeaf()) {
+            _support = _value.Support();
+        } else {
+            // the store never creates inner nodes with an empty nested set
+            std::vector<const NSFNode*>::const_iterator it = _nestedSet.begin();
+            _support = (*it)->support();
+            for (it++; it != _nestedSet.end(); it++) {
+                _support *= (*it)->support();
+            }
+        }
+        _supportValid = true;
+    }
+    return _support;
+}
+
+/**
+ * The support is a cube of positive literals, hence it implies a single
+ * (positive) variable iff the variable occurs in it. For a cube of variables
+ * it suffices that one of them occurs, i.e. abstracting the cube from the
+ * support changes it.
+ **/
+bool NSFNode::dependsOn(const BDD& variables) const {
+    if (variables.IsVar()) {
+        return support() <= variables;
+    }
+    return support().ExistAbstract(variables, 0) != support();
+}
+
+const unsigned int NSFNode::leavesCount() const {
+    return _leavesCount;
+}
+
+const unsigned int NSFNode::nsfCount() const {
+    return _nsfCount;
+}
+
+void NSFNode::print(bool verbose) const {
+    if (verbose) {
+        if (isExistentiallyQuantified()) std::cout << "E";
+        else if (isUniversiallyQuantified()) std::cout << "A";
+        else std::cout << "U";
+        std::cout << " l" << _level;
+        std::cout << " d" << _depth << " ";
+    }
+    if (isLeaf()) {
+        if (value().IsZero()) {
+            std::cout << "[B]";
+        } else if (value().IsOne()) {
+            std::cout << "[T]";
+        } else {
+            std::cout << "[" << _value.nodeCount() << "]";
+            if (verbose) {
+                std::cout << std::endl;
+                _value.print(0, 2);
+                std::cout << std::endl;
+            }
+        }
+    } else {
+        std::cout << "{";
+        for (const NSFNode* childComp : _nestedSet) {
+            childComp->print(verbose);
+        }
+        std::cout << "}";
+    }
+}
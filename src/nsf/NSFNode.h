@@ -0,0 +1,108 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "cuddObj.hh"
+
+#include "../Instance.h"
+
+class NSFNodeStore;
+
+/**
+ * Immutable, hash-consed node of a nested set of formulas.
+ * 
+ * Nodes are only created by an NSFNodeStore, which guarantees that structurally
+ * identical nodes (same level, quantifier and leaf BDD or set of children) exist
+ * at most once. Hence, two nodes are equal iff they are the same object.
+ * Nodes are reference counted, see NSFNodeStore::retain and NSFNodeStore::release.
+ * 
+ * Each node caches a structural fingerprint (computed from leaf DdNodes and child
+ * fingerprints) and keeps its nested set ordered by it, so equality and
+ * containment checks are merge scans. A bloom-style signature over the
+ * nested set allows to rule out containment without scanning.
+ * Since nodes never change, size aggregates and the support (the variables
+ * occurring in some leaf below) are cached as well.
+ **/
+class NSFNode {
+public:
+    NSFNode(unsigned int level, unsigned int depth, NTYPE type, const BDD& value);
+    NSFNode(unsigned int level, unsigned int depth, NTYPE type, std::vector<const NSFNode*>& nestedSet);
+
+    const BDD& value() const;
+    const std::vector<const NSFNode *>& nestedSet() const;
+
+    unsigned long id() const;
+    uint64_t fingerprint() const;
+    uint64_t signature() const;
+    unsigned int depth() const;
+    unsigned int level() const;
+    NTYPE quantifier() const;
+    bool isLeaf() const;
+    bool isExistentiallyQuantified() const;
+    bool isUniversiallyQuantified() const;
+
+    size_t hash() const;
+    bool sameStructure(const NSFNode& other) const;
+
+    static bool fingerprintOrder(const NSFNode* n1, const NSFNode* n2);
+
+    bool operator<=(const NSFNode& other) const;
+    bool maybeSubsetOf(const NSFNode& other) const;
+
+    const unsigned int maxBDDsize() const;
+    const unsigned int leavesCount() const;
+    const unsigned int nsfCount() const;
+
+    const BDD& support() const;
+    bool dependsOn(const BDD& variables) const;
+
+    void print(bool verbose = false) const;
+
+private:
+    friend class NSFNodeStore;
+
+    void computeFingerprint();
+    void computeSignature();
+    void computeAggregates();
+
+    unsigned long _id;
+    uint64_t _fingerprint;
+    uint64_t _signature;
+    mutable unsigned int _references;
+
+    unsigned int _level;
+    unsigned int _depth;
+    NTYPE _type;
+    BDD _value;
+    std::vector<const NSFNode *> _nestedSet; // sorted by fingerprintOrder
+
+    // cached aggregates, _maxBDDsize is computed on first use
+    unsigned int _leavesCount;
+    unsigned int _nsfCount;
+    mutable unsigned int _maxBDDsize;
+    mutable bool _maxBDDsizeValid;
+    mutable BDD _support; // cube, computed on first use
+    mutable bool _supportValid;
+};
@@ -0,0 +1,57 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "NSFNodePool.h"
+
+NSFNodePool::NSFNodePool()
+: _free(nullptr) {
+}
+
+NSFNodePool::~NSFNodePool() {
+    for (Slot* block : _blocks) {
+        delete[] block;
+    }
+    _blocks.clear();
+}
+
+void* NSFNodePool::allocate() {
+    if (_free == nullptr) {
+        Slot* block = new Slot[BLOCK_SIZE];
+        _blocks.push_back(block);
+        for (unsigned int i = 0; i < BLOCK_SIZE; i++) {
+            block[i].next = _free;
+            _free = &block[i];
+        }
+    }
+    Slot* slot = _free;
+    _free = slot->next;
+    return slot->storage;
+}
+
+void NSFNodePool::deallocate(void* slot) {
+    Slot* s = static_cast<Slot*> (slot);
+    s->next = _free;
+    _free = s;
+}
+
+unsigned int NSFNodePool::blocks() const {
+    return _blocks.size();
+}
@@ -0,0 +1,55 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "NSFNode.h"
+
+/**
+ * Slab allocator for NSF nodes.
+ * 
+ * Nodes are carved out of blocks of fixed size, freed slots are kept in a free
+ * list and reused by subsequent allocations. The blocks themselves are only
+ * given back to the system when the pool is destroyed.
+ **/
+class NSFNodePool {
+public:
+    NSFNodePool();
+    ~NSFNodePool();
+
+    void* allocate();
+    void deallocate(void* slot);
+
+    unsigned int blocks() const;
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(NSFNode) unsigned char storage[sizeof(NSFNode)];
+    };
+
+    static const unsigned int BLOCK_SIZE = 1024;
+
+    std::vector<Slot*> _blocks;
+    Slot* _free;
+};
@@ -0,0 +1,193 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <algorithm>
+#include <new>
+#include <cassert>
+
+#include "NSFNodeStore.h"
+
+NSFNodeStore::NSFNodeStore()
+: _nextId(1)
+, _maxSize(0)
+, _hits(0)
+, _subsetChecks(0)
+, _filteredSubsetChecks(0)
+, _fusedAbstractions(0)
+, _fusedAbstractionNodesBefore(0)
+, _fusedAbstractionNodesAfter(0)
+, _minimizations(0)
+, _minimizationNodesBefore(0)
+, _minimizationNodesAfter(0) {
+}
+
+NSFNodeStore::~NSFNodeStore() {
+    // nodes that are still referenced (e.g. after an abort) are destroyed here,
+    // their memory is released in bulk by the pool
+    for (const NSFNode* node : _uniqueTable) {
+        node->~NSFNode();
+    }
+    _uniqueTable.clear();
+}
+
+const NSFNode* NSFNodeStore::leaf(unsigned int level, NTYPE type, const BDD& value) {
+    NSFNode probe(level, 0, type, value);
+    return lookup(probe);
+}
+
+const NSFNode* NSFNodeStore::inner(unsigned int level, unsigned int depth, NTYPE type, std::vector<const NSFNode*>& nestedSet) {
+    // inner nodes derive their support from the first child (see NSFNode::support)
+    assert(!nestedSet.empty());
+    std::sort(nestedSet.begin(), nestedSet.end(), NSFNode::fingerprintOrder);
+    // nested sets are sets, hence duplicates are dropped
+    std::vector<const NSFNode*> uniqueNestedSet;
+    uniqueNestedSet.reserve(nestedSet.size());
+    for (const NSFNode* n : nestedSet) {
+        if (!uniqueNestedSet.empty() && uniqueNestedSet.back() == n) {
+            release(n);
+        } else {
+            uniqueNestedSet.push_back(n);
+        }
+    }
+    nestedSet.clear();
+    NSFNode probe(level, depth, type, uniqueNestedSet);
+    return lookup(probe);
+}
+
+const NSFNode* NSFNodeStore::lookup(NSFNode& probe) {
+    std::unordered_set<const NSFNode*, NodeHash, NodeEqual>::iterator it = _uniqueTable.find(&probe);
+    if (it != _uniqueTable.end()) {
+        _hits++;
+        for (const NSFNode* child : probe._nestedSet) {
+            release(child);
+        }
+        retain(*it);
+        return *it;
+    }
+    NSFNode* node;
+    if (probe.isLeaf()) {
+        node = new (_pool.allocate()) NSFNode(probe._level, 0, probe._type, probe._value);
+    } else {
+        node = new (_pool.allocate()) NSFNode(probe._level, probe._depth, probe._type, probe._nestedSet);
+    }
+    node->_id = _nextId++;
+    node->_references = 1;
+    _uniqueTable.insert(node);
+    if (_uniqueTable.size() > _maxSize) {
+        _maxSize = _uniqueTable.size();
+    }
+    return node;
+}
+
+void NSFNodeStore::retain(const NSFNode* node) {
+    node->_references++;
+}
+
+void NSFNodeStore::release(const NSFNode* node) {
+    node->_references--;
+    if (node->_references == 0) {
+        _uniqueTable.erase(node);
+        for (const NSFNode* child : node->_nestedSet) {
+            release(child);
+        }
+        destroy(node);
+    }
+}
+
+void NSFNodeStore::destroy(const NSFNode* node) {
+    node->~NSFNode();
+    _pool.deallocate(const_cast<NSFNode*> (node));
+}
+
+unsigned int NSFNodeStore::size() const {
+    return _uniqueTable.size();
+}
+
+unsigned int NSFNodeStore::maxSize() const {
+    return _maxSize;
+}
+
+unsigned long NSFNodeStore::hits() const {
+    return _hits;
+}
+
+unsigned int NSFNodeStore::poolBlocks() const {
+    return _pool.blocks();
+}
+
+void NSFNodeStore::countSubsetCheck(bool filtered) {
+    _subsetChecks++;
+    if (filtered) {
+        _filteredSubsetChecks++;
+    }
+}
+
+unsigned long NSFNodeStore::subsetChecks() const {
+    return _subsetChecks;
+}
+
+unsigned long NSFNodeStore::filteredSubsetChecks() const {
+    return _filteredSubsetChecks;
+}
+
+/**
+ * Records a conjunction with clauses that was fused with an abstraction, along
+ * with the BDD nodes of the affected leaves before and after.
+ **/
+void NSFNodeStore::countFusedAbstraction(unsigned long nodesBefore, unsigned long nodesAfter) {
+    _fusedAbstractions++;
+    _fusedAbstractionNodesBefore += nodesBefore;
+    _fusedAbstractionNodesAfter += nodesAfter;
+}
+
+unsigned long NSFNodeStore::fusedAbstractions() const {
+    return _fusedAbstractions;
+}
+
+unsigned long NSFNodeStore::fusedAbstractionNodesBefore() const {
+    return _fusedAbstractionNodesBefore;
+}
+
+unsigned long NSFNodeStore::fusedAbstractionNodesAfter() const {
+    return _fusedAbstractionNodesAfter;
+}
+
+/**
+ * Records a don't care minimization of leaves, along with the BDD nodes of the
+ * leaves before and after.
+ **/
+void NSFNodeStore::countMinimization(unsigned long nodesBefore, unsigned long nodesAfter) {
+    _minimizations++;
+    _minimizationNodesBefore += nodesBefore;
+    _minimizationNodesAfter += nodesAfter;
+}
+
+unsigned long NSFNodeStore::minimizations() const {
+    return _minimizations;
+}
+
+unsigned long NSFNodeStore::minimizationNodesBefore() const {
+    return _minimizationNodesBefore;
+}
+
+unsigned long NSFNodeStore::minimizationNodesAfter() const {
+    return _minimizationNodesAfter;
+}
@@ -0,0 +1,100 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include "NSFNode.h"
+#include "NSFNodePool.h"
+
+/**
+ * Unique table for NSF nodes.
+ * 
+ * Every node handed out by the store carries one reference that is owned by the
+ * caller and has to be given back via release(). Children references passed
+ * to inner() are consumed by the store, the nested set must not be empty.
+ * Nodes are allocated from a pool that is released in bulk with the store.
+ **/
+class NSFNodeStore {
+public:
+    NSFNodeStore();
+    ~NSFNodeStore();
+
+    const NSFNode* leaf(unsigned int level, NTYPE type, const BDD& value);
+    const NSFNode* inner(unsigned int level, unsigned int depth, NTYPE type, std::vector<const NSFNode*>& nestedSet);
+
+    void retain(const NSFNode* node);
+    void release(const NSFNode* node);
+
+    unsigned int size() const;
+    unsigned int maxSize() const;
+    unsigned long hits() const;
+    unsigned int poolBlocks() const;
+
+    void countSubsetCheck(bool filtered);
+    unsigned long subsetChecks() const;
+    unsigned long filteredSubsetChecks() const;
+
+    void countFusedAbstraction(unsigned long nodesBefore, unsigned long nodesAfter);
+    unsigned long fusedAbstractions() const;
+    unsigned long fusedAbstractionNodesBefore() const;
+    unsigned long fusedAbstractionNodesAfter() const;
+
+    void countMinimization(unsigned long nodesBefore, unsigned long nodesAfter);
+    unsigned long minimizations() const;
+    unsigned long minimizationNodesBefore() const;
+    unsigned long minimizationNodesAfter() const;
+
+private:
+
+    struct NodeHash {
+        size_t operator()(const NSFNode* node) const {
+            return node->hash();
+        }
+    };
+
+    struct NodeEqual {
+        bool operator()(const NSFNode* n1, const NSFNode* n2) const {
+            return n1->sameStructure(*n2);
+        }
+    };
+
+    const NSFNode* lookup(NSFNode& probe);
+    void destroy(const NSFNode* node);
+
+    std::unordered_set<const NSFNode*, NodeHash, NodeEqual> _uniqueTable;
+    unsigned long _nextId;
+    NSFNodePool _pool;
+
+    // statistics
+    unsigned int _maxSize;
+    unsigned long _hits;
+    unsigned long _subsetChecks;
+    unsigned long _filteredSubsetChecks;
+    unsigned long _fusedAbstractions;
+    unsigned long _fusedAbstractionNodesBefore;
+    unsigned long _fusedAbstractionNodesAfter;
+    unsigned long _minimizations;
+    unsigned long _minimizationNodesBefore;
+    unsigned long _minimizationNodesAfter;
+};
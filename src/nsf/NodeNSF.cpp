@@ -0,0 +1,1246 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <climits>
+
+#include "NodeNSF.h"
+
+NodeNSF::NodeNSF(NSFNodeStore& store, const std::vector<NTYPE>& quantifierSequence, const BDD& bdd) :
+_store(store),
+_pendingAntichain(false),
+_evaluatedKeepFirstLevel(false) {
+    unsigned int level = quantifierSequence.size();
+    unsigned int depth = 0;
+    const NSFNode* current = _store.leaf(level, quantifierSequence.at(level - 1), bdd);
+    while (level > 1) {
+        level--;
+        depth++;
+        std::vector<const NSFNode*> nestedSet(1, current);
+        current = _store.inner(level, depth, quantifierSequence.at(level - 1), nestedSet);
+    }
+    _root = current;
+}
+
+NodeNSF::NodeNSF(const NodeNSF& other) :
+_store(other._store),
+_root(other._root),
+_pendingProduct(other._pendingProduct),
+_pendingAntichain(other._pendingAntichain),
+_pendingClauses(other._pendingClauses),
+_evaluatedKeepFirstLevel(false) {
+    _store.retain(_root);
+    for (const NSFNode* factor : _pendingProduct) {
+        _store.retain(factor);
+    }
+}
+
+NodeNSF::~NodeNSF() {
+    _store.release(_root);
+    for (const NSFNode* factor : _pendingProduct) {
+        _store.release(factor);
+    }
+    releaseAll(_evaluated);
+}
+
+NSF* NodeNSF::copy() const {
+    return new NodeNSF(*this);
+}
+
+bool NodeNSF::operator==(const NSF& other) const {
+    const NodeNSF* o = dynamic_cast<const NodeNSF*> (&other);
+    // nodes are hash-consed
+    return o != NULL && root() == o->root();
+}
+
+bool NodeNSF::operator!=(const NSF& other) const {
+    return !(*this == other);
+}
+
+bool NodeNSF::operator<=(const NSF& other) const {
+    const NodeNSF& o = dynamic_cast<const NodeNSF&> (other);
+    return (*root()) <= (*o.root());
+}
+
+const NSFNode* NodeNSF::root() const {
+    materialize();
+    conjoinPendingClauses(_root);
+    return _root;
+}
+
+unsigned int NodeNSF::depth() const {
+    return _root->depth();
+}
+
+unsigned int NodeNSF::level() const {
+    return _root->level();
+}
+
+NTYPE NodeNSF::quantifier() const {
+    return _root->quantifier();
+}
+
+/**
+ * Pending clauses are shared by all leaves, hence they are not conjoined to
+ * measure the leaves. For a pending product, the size is estimated by the sum
+ * of the factors' sizes (leaves of the product conjoin one leaf per factor).
+ **/
+const unsigned int NodeNSF::maxBDDsize() const {
+    unsigned long size = _root->maxBDDsize();
+    for (const NSFNode* factor : _pendingProduct) {
+        size = std::min(size + factor->maxBDDsize(), (unsigned long) UINT_MAX);
+    }
+    return (unsigned int) size;
+}
+
+/**
+ * For a pending product, the number of leaves is estimated by the product of
+ * the factors' leaf counts (an upper bound, since duplicates are dropped). It
+ * saturates at UINT_MAX instead of wrapping around.
+ **/
+const unsigned int NodeNSF::leavesCount() const {
+    unsigned long count = _root->leavesCount();
+    for (const NSFNode* factor : _pendingProduct) {
+        count = std::min(count * factor->leavesCount(), (unsigned long) UINT_MAX);
+    }
+    return (unsigned int) count;
+}
+
+const unsigned int NodeNSF::nsfCount() const {
+    return root()->nsfCount();
+}
+
+void NodeNSF::print(bool verbose) const {
+    root()->print(verbose);
+}
+
+void NodeNSF::apply(const std::function<BDD(const BDD&)>& f) {
+    materialize();
+    conjoinPendingClauses(_root);
+    NodeMap memo;
+    replaceFactor(_root, apply(_root, f, memo));
+    releaseAll(memo);
+}
+
+/**
+ * Conjunction distributes over a pending product, hence it suffices to
+ * apply the clauses to the first factor.
+ **/
+void NodeNSF::apply(const BDD& clauses) {
+    NodeMap memo;
+    replaceFactor(_root, apply(_root, [&clauses](const BDD& bdd) -> BDD {
+        return bdd * clauses;
+    }, memo));
+    releaseAll(memo);
+}
+
+void NodeNSF::applyLazily(const BDD& clauses) {
+    _pendingClauses.push_back(clauses);
+}
+
+/**
+ * Conjoins clauses with all leaves and abstracts the variables in cube at
+ * level vl in the same pass, without building the conjunction first.
+ **/
+void NodeNSF::applyAbstract(const BDD& clauses, const BDD& cube, const unsigned int vl) {
+    const NSFNode** factor = dependentFactor(cube);
+    if (factor == NULL) {
+        materialize();
+        factor = &_root;
+    }
+    _pendingClauses.push_back(clauses);
+    abstractPendingClauses(*factor, cube, vl);
+}
+
+/**
+ * Pending clauses of both NSFs apply to all leaves of the product. Subsumption
+ * among the products is preserved by conjoining them later, hence antichains
+ * can be computed before.
+ **/
+void NodeNSF::conjunct(const NSF& other, bool antichain) {
+    const NodeNSF& o = dynamic_cast<const NodeNSF&> (other);
+    materialize();
+    o.materialize();
+    NodePairMap memo;
+    replaceFactor(_root, conjunct(_root, o._root, antichain, memo));
+    releaseAll(memo);
+    _pendingClauses.insert(_pendingClauses.end(), o._pendingClauses.begin(), o._pendingClauses.end());
+}
+
+void NodeNSF::conjunctLazily(const NSF& other, bool antichain) {
+    const NodeNSF& o = dynamic_cast<const NodeNSF&> (other);
+    _pendingAntichain = _pendingAntichain || antichain || o._pendingAntichain;
+    _store.retain(o._root);
+    _pendingProduct.push_back(o._root);
+    for (const NSFNode* factor : o._pendingProduct) {
+        _store.retain(factor);
+        _pendingProduct.push_back(factor);
+    }
+    _pendingClauses.insert(_pendingClauses.end(), o._pendingClauses.begin(), o._pendingClauses.end());
+}
+
+bool NodeNSF::hasPendingProduct() const {
+    return !_pendingProduct.empty();
+}
+
+/**
+ * A pending product is only materialized if several factors depend on
+ * variable (see dependentFactor).
+ **/
+void NodeNSF::removeAbstract(const BDD& variable, const unsigned int vl) {
+    const NSFNode** factor = dependentFactor(variable);
+    if (factor == NULL) {
+        materialize();
+        factor = &_root;
+    }
+    if (pendingClausesDependOn(variable)) {
+        abstractPendingClauses(*factor, variable, vl);
+        return;
+    }
+    NodeMap memo;
+    replaceFactor(*factor, removeAbstract(*factor, variable, vl, memo));
+    releaseAll(memo);
+}
+
+/**
+ * Returns the number of children that were not duplicated by splits
+ * since both of their cofactors coincide. As for removeAbstract, a pending
+ * product is only materialized if several factors depend on variable.
+ **/
+unsigned int NodeNSF::remove(const BDD& variable, const unsigned int vl) {
+    const NSFNode** factor = dependentFactor(variable);
+    if (factor == NULL) {
+        materialize();
+        factor = &_root;
+    }
+    if (pendingClausesDependOn(variable)) {
+        if (vl == _root->level() + _root->depth()) {
+            // innermost variables are abstracted
+            abstractPendingClauses(*factor, variable, vl);
+            return 0;
+        }
+        conjoinPendingClauses(*factor);
+    }
+    NodeMap memo;
+    unsigned int avoidedCopies = 0;
+    replaceFactor(*factor, remove(*factor, variable, vl, memo, avoidedCopies));
+    releaseAll(memo);
+    return avoidedCopies;
+}
+
+/**
+ * Elements subsumed within a factor only lead to products that are subsumed
+ * as well (see conjunct), hence the factors of a pending product are
+ * optimized separately instead of materializing the product.
+ **/
+bool NodeNSF::optimize() {
+    conjoinPendingClauses(_root);
+    NodeMap memo;
+    bool changed = false;
+    for (const NSFNode** factor : factors()) {
+        const NSFNode* optimized = optimize(*factor, memo);
+        changed = changed || (optimized != *factor);
+        replaceFactor(*factor, optimized);
+    }
+    releaseAll(memo);
+    return changed;
+}
+
+bool NodeNSF::optimize(bool left) {
+    conjoinPendingClauses(_root);
+    NodeMap memo;
+    bool changed = false;
+    for (const NSFNode** factor : factors()) {
+        changed = optimize(*factor, left, memo) || changed;
+    }
+    releaseAll(memo);
+    return changed;
+}
+
+/**
+ * Leaves only matter where the pending clauses hold, since they are conjoined
+ * later on. Hence, each leaf is replaced by the result of minimizer for the
+ * pending clauses as care set, unless this does not shrink the leaf.
+ **/
+void NodeNSF::minimize(const std::function<BDD(const BDD&, const BDD&)>& minimizer) {
+    if (_pendingClauses.empty()) {
+        return;
+    }
+    materialize();
+    BDD careSet = pendingClauses();
+    unsigned long nodesBefore = 0;
+    unsigned long nodesAfter = 0;
+    NodeMap memo;
+    replaceFactor(_root, apply(_root, [&](const BDD& b) -> BDD {
+        unsigned int size = b.nodeCount();
+        BDD result = minimizer(b, careSet);
+        unsigned int minimizedSize = result.nodeCount();
+        nodesBefore += size;
+        if (minimizedSize >= size) {
+            nodesAfter += size;
+            return b;
+        }
+        nodesAfter += minimizedSize;
+        return result;
+    }, memo));
+    releaseAll(memo);
+    _store.countMinimization(nodesBefore, nodesAfter);
+}
+
+BDD NodeNSF::truncate(const std::vector<BDD>& cubesAtlevels) {
+    return truncate(root(), cubesAtlevels);
+}
+
+/**
+ * changedVariables[l - 1] contains all variables whose cube membership at
+ * some level >= l differs from the last evaluation. The memoized result of a
+ * node at level l stays valid iff none of them is in its support.
+ **/
+const BDD NodeNSF::evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel) {
+    // the exact result needs the product
+    materialize();
+    bool withinBudget;
+    return evaluate(cubesAtlevels, keepFirstLevel, 0, withinBudget);
+}
+
+/**
+ * Gives up once the leaf BDDs evaluated so far exceed budget nodes in total
+ * (0 for no limit). In that case, withinBudget is false and the result is undefined.
+ * While a product is pending, it is not materialized whatever the budget: the
+ * product is only refuted via one of its factors (see refute), otherwise
+ * withinBudget is false as well.
+ **/
+const BDD NodeNSF::evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) {
+    if (!_pendingProduct.empty()) {
+        return refute(cubesAtlevels, keepFirstLevel, budget, withinBudget);
+    }
+    BDD clauses;
+    if (!_pendingClauses.empty()) {
+        clauses = pendingClauses();
+    }
+    std::vector<BDD> changedVariables;
+    if (keepFirstLevel == _evaluatedKeepFirstLevel && cubesAtlevels.size() == _evaluatedCubes.size() && _pendingClauses == _evaluatedClauses) {
+        changedVariables.resize(cubesAtlevels.size());
+        for (unsigned int level = cubesAtlevels.size(); level >= 1; level--) {
+            const BDD& oldCube = _evaluatedCubes.at(level - 1);
+            const BDD& newCube = cubesAtlevels.at(level - 1);
+            BDD changed = oldCube.ExistAbstract(newCube, 0) * newCube.ExistAbstract(oldCube, 0);
+            if (level < cubesAtlevels.size()) {
+                changed *= changedVariables.at(level);
+            }
+            changedVariables.at(level - 1) = changed;
+        }
+    } else {
+        releaseAll(_evaluated);
+    }
+    if (!changedVariables.empty() && !_pendingClauses.empty()) {
+        // memoized results also depend on the variables of the clauses
+        BDD support = clauses.Support();
+        if (support != support.ExistAbstract(changedVariables.front(), 0)) {
+            changedVariables.clear();
+            releaseAll(_evaluated);
+        }
+    }
+    EvaluationMap evaluated;
+    unsigned long cost = 0;
+    BDD result = evaluate(_root, cubesAtlevels, keepFirstLevel, _pendingClauses.empty() ? NULL : &clauses, changedVariables, evaluated, budget, cost);
+    withinBudget = (budget == 0 || cost <= budget);
+    // only keep results for nodes of the current NSF
+    releaseAll(_evaluated);
+    _evaluated.swap(evaluated);
+    _evaluatedCubes = cubesAtlevels;
+    _evaluatedKeepFirstLevel = keepFirstLevel;
+    _evaluatedClauses = _pendingClauses;
+    return result;
+}
+
+/**
+ * A pending product is unsat if one of its factors is, it is only
+ * materialized if none of them is.
+ **/
+bool NodeNSF::isUnsat() const {
+    BDD clauses;
+    if (!_pendingClauses.empty()) {
+        clauses = pendingClauses();
+    }
+    const BDD* clausesPointer = _pendingClauses.empty() ? NULL : &clauses;
+    if (!_pendingProduct.empty()) {
+        if (isUnsat(_root, clausesPointer)) {
+            return true;
+        }
+        for (const NSFNode* factor : _pendingProduct) {
+            if (isUnsat(factor, clausesPointer)) {
+                return true;
+            }
+        }
+        materialize();
+    }
+    return isUnsat(_root, clausesPointer);
+}
+
+/**
+ * The product implies each of its factors, hence it evaluates to false if
+ * one factor does. The result is false within budget in that case, otherwise
+ * withinBudget is false.
+ **/
+const BDD NodeNSF::refute(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) {
+    BDD clauses;
+    if (!_pendingClauses.empty()) {
+        clauses = pendingClauses();
+    }
+    std::vector<BDD> changedVariables;
+    EvaluationMap evaluated;
+    unsigned long cost = 0;
+    BDD result;
+    withinBudget = false;
+    for (const NSFNode** factor : factors()) {
+        BDD value = evaluate(*factor, cubesAtlevels, keepFirstLevel, _pendingClauses.empty() ? NULL : &clauses, changedVariables, evaluated, budget, cost);
+        if (budget > 0 && cost > budget) {
+            break;
+        }
+        if (value.IsZero()) {
+            result = value;
+            withinBudget = true;
+            break;
+        }
+    }
+    releaseAll(evaluated);
+    return result;
+}
+
+/**
+ * Maps the leaves through approximate while evaluating, neither the nodes nor
+ * the pending product or clauses are changed, and the memoized exact results
+ * are neither used nor replaced. The clauses are conjoined with the
+ * approximated leaves, which bounds the leaves in effect in the same direction.
+ * A pending product implies each of its factors (see refute), hence the
+ * conjunction of the factor values is an upper bound. No lower bound is
+ * available without materializing the product, bounded is false in that case.
+ **/
+const BDD NodeNSF::evaluateApproximation(const std::vector<BDD>& cubesAtlevels, const std::function<BDD(const BDD&)>& approximate, const bool upperBound, bool& bounded) {
+    if (!_pendingProduct.empty() && !upperBound) {
+        bounded = false;
+        return BDD();
+    }
+    BDD clauses;
+    if (!_pendingClauses.empty()) {
+        clauses = pendingClauses();
+    }
+    std::vector<BDD> changedVariables;
+    EvaluationMap evaluated;
+    unsigned long cost = 0;
+    BDD result;
+    bool first = true;
+    for (const NSFNode** factor : factors()) {
+        BDD value = evaluate(*factor, cubesAtlevels, false, _pendingClauses.empty() ? NULL : &clauses, changedVariables, evaluated, 0, cost, &approximate);
+        result = first ? value : result * value;
+        if (result.IsZero()) {
+            break;
+        }
+        first = false;
+    }
+    releaseAll(evaluated);
+    bounded = true;
+    return result;
+}
+
+/**
+ * Returns up to limit (0 for no limit) distinct leaves whose BDD contains
+ * variable. Leaves are returned as they are in effect, i.e. conjoined with the
+ * pending clauses (all leaves depend on variable if the clauses do). A pending
+ * product is not materialized, the leaves of its factors stand in for its leaves.
+ **/
+std::vector<BDD> NodeNSF::leavesDependingOn(const BDD& variable, const unsigned int limit) const {
+    bool everyLeaf = pendingClausesDependOn(variable);
+    std::vector<BDD> leaves;
+    std::unordered_set<const NSFNode*> visited;
+    leavesDependingOn(_root, variable, everyLeaf, limit, leaves, visited);
+    for (const NSFNode* factor : _pendingProduct) {
+        leavesDependingOn(factor, variable, everyLeaf, limit, leaves, visited);
+    }
+    if (!_pendingClauses.empty()) {
+        BDD clauses = pendingClauses();
+        for (BDD& leaf : leaves) {
+            leaf *= clauses;
+        }
+    }
+    return leaves;
+}
+
+/**
+ * Same as leavesDependingOn(variable, 0).size(), without building the leaves.
+ **/
+unsigned int NodeNSF::countLeavesDependingOn(const BDD& variable) const {
+    bool everyLeaf = pendingClausesDependOn(variable);
+    std::unordered_set<const NSFNode*> visited;
+    unsigned int count = countLeavesDependingOn(_root, variable, everyLeaf, visited);
+    for (const NSFNode* factor : _pendingProduct) {
+        count += countLeavesDependingOn(factor, variable, everyLeaf, visited);
+    }
+    return count;
+}
+
+template <typename LeafOperation>
+const NSFNode* NodeNSF::apply(const NSFNode* node, const LeafOperation& f, NodeMap& memo) const {
+    NodeMap::const_iterator it = memo.find(node);
+    if (it != memo.end()) {
+        _store.retain(it->second);
+        return it->second;
+    }
+    const NSFNode* result;
+    if (node->isLeaf()) {
+        result = _store.leaf(node->level(), node->quantifier(), f(node->value()));
+    } else {
+        std::vector<const NSFNode*> nestedSet;
+        nestedSet.reserve(node->nestedSet().size());
+        for (const NSFNode* n : node->nestedSet()) {
+            nestedSet.push_back(apply(n, f, memo));
+        }
+        result = _store.inner(node->level(), node->depth(), node->quantifier(), nestedSet);
+    }
+    _store.retain(result);
+    memo[node] = result;
+    return result;
+}
+
+/**
+ * Same as apply, but leaves subtrees that do not depend on variable untouched.
+ * Hence, f must not change BDDs that do not contain variable.
+ **/
+template <typename LeafOperation>
+const NSFNode* NodeNSF::apply(const NSFNode* node, const BDD& variable, const LeafOperation& f, NodeMap& memo) const {
+    if (!node->dependsOn(variable)) {
+        _store.retain(node);
+        return node;
+    }
+    NodeMap::const_iterator it = memo.find(node);
+    if (it != memo.end()) {
+        _store.retain(it->second);
+        return it->second;
+    }
+    const NSFNode* result;
+    if (node->isLeaf()) {
+        result = _store.leaf(node->level(), node->quantifier(), f(node->value()));
+    } else {
+        std::vector<const NSFNode*> nestedSet;
+        nestedSet.reserve(node->nestedSet().size());
+        for (const NSFNode* n : node->nestedSet()) {
+            nestedSet.push_back(apply(n, variable, f, memo));
+        }
+        result = _store.inner(node->level(), node->depth(), node->quantifier(), nestedSet);
+    }
+    _store.retain(result);
+    memo[node] = result;
+    return result;
+}
+
+/**
+ * With antichain reduction, products of leaves are not memoized: most of them
+ * are dominated and dropped by insertIntoAntichain, and a memo entry would keep
+ * their BDDs alive until the end of the join. Recomputing a repeated pair is a
+ * single conjunction that CUDD answers from its computed table.
+ **/
+const NSFNode* NodeNSF::conjunct(const NSFNode* n1, const NSFNode* n2, bool antichain, NodePairMap& memo) const {
+    if (antichain && n1->isLeaf()) {
+        return _store.leaf(n1->level(), n1->quantifier(), n1->value() * n2->value());
+    }
+    std::pair<const NSFNode*, const NSFNode*> key(n1, n2);
+    NodePairMap::const_iterator it = memo.find(key);
+    if (it != memo.end()) {
+        _store.retain(it->second);
+        return it->second;
+    }
+    const NSFNode* result;
+    if (n1->isLeaf()) {
+        result = _store.leaf(n1->level(), n1->quantifier(), n1->value() * n2->value());
+    } else {
+        std::vector<const NSFNode*> nestedSet;
+        if (!antichain) {
+            nestedSet.reserve(n1->nestedSet().size() * n2->nestedSet().size());
+        }
+        for (const NSFNode* c1 : n1->nestedSet()) {
+            for (const NSFNode* c2 : n2->nestedSet()) {
+                const NSFNode* product = conjunct(c1, c2, antichain, memo);
+                if (antichain) {
+                    insertIntoAntichain(nestedSet, product, n1);
+                } else {
+                    nestedSet.push_back(product);
+                }
+            }
+        }
+        result = _store.inner(n1->level(), n1->depth(), n1->quantifier(), nestedSet);
+    }
+    _store.retain(result);
+    memo[key] = result;
+    return result;
+}
+
+const NSFNode* NodeNSF::removeAbstract(const NSFNode* node, const BDD& variable, const unsigned int vl, NodeMap& memo) {
+    if (!node->dependsOn(variable)) {
+        // no leaf below is affected
+        _store.retain(node);
+        return node;
+    }
+    if (node->level() == vl) {
+        NodeMap abstractMemo;
+        const NSFNode* result;
+        if (node->isExistentiallyQuantified()) {
+            result = apply(node, variable, [&variable] (const BDD& b) -> BDD {
+                return b.ExistAbstract(variable, 0);
+            }, abstractMemo);
+        } else {
+            result = apply(node, variable, [&variable] (const BDD& b) -> BDD {
+                return b.UnivAbstract(variable);
+            }, abstractMemo);
+        }
+        releaseAll(abstractMemo);
+        return result;
+    }
+    NodeMap::const_iterator it = memo.find(node);
+    if (it != memo.end()) {
+        _store.retain(it->second);
+        return it->second;
+    }
+    std::vector<const NSFNode*> nestedSet;
+    nestedSet.reserve(node->nestedSet().size());
+    for (const NSFNode* n : node->nestedSet()) {
+        nestedSet.push_back(removeAbstract(n, variable, vl, memo));
+    }
+    const NSFNode* result = _store.inner(node->level(), node->depth(), node->quantifier(), nestedSet);
+    _store.retain(result);
+    memo[node] = result;
+    return result;
+}
+
+const NSFNode* NodeNSF::remove(const NSFNode* node, const BDD& variable, const unsigned int vl, NodeMap& memo, unsigned int& avoidedCopies) {
+    if (!node->dependsOn(variable)) {
+        // no leaf below is affected, hence neither abstraction nor split changes anything
+        _store.retain(node);
+        return node;
+    }
+    NodeMap::const_iterator it = memo.find(node);
+    if (it != memo.end()) {
+        _store.retain(it->second);
+        return it->second;
+    }
+    const NSFNode* result;
+    if (node->level() == vl) {
+        if (node->isLeaf()) {
+            if (node->isExistentiallyQuantified()) {
+                result = _store.leaf(node->level(), node->quantifier(), node->value().ExistAbstract(variable, 0));
+            } else {
+                result = _store.leaf(node->level(), node->quantifier(), node->value().UnivAbstract(variable));
+            }
+        } else {
+            NodeMap positiveMemo;
+            NodeMap negativeMemo;
+            BDD negatedVariable = !variable;
+            std::vector<const NSFNode*> nestedSet;
+            nestedSet.reserve(node->nestedSet().size() * 2);
+            for (const NSFNode* n : node->nestedSet()) {
+                if (!n->dependsOn(variable)) {
+                    // both restrictions are n itself
+                    _store.retain(n);
+                    nestedSet.push_back(n);
+                    avoidedCopies++;
+                    continue;
+                }
+                const NSFNode* positive = apply(n, variable, [&variable] (const BDD& b) -> BDD {
+                    return b.Restrict(variable);
+                }, positiveMemo);
+                const NSFNode* negative = apply(n, variable, [&negatedVariable] (const BDD& b) -> BDD {
+                    return b.Restrict(negatedVariable);
+                }, negativeMemo);
+                nestedSet.push_back(positive);
+                // nodes are hash-consed, hence equal cofactors are the same node
+                if (negative == positive) {
+                    _store.release(negative);
+                    avoidedCopies++;
+                } else {
+                    nestedSet.push_back(negative);
+                }
+            }
+            releaseAll(positiveMemo);
+            releaseAll(negativeMemo);
+            result = _store.inner(node->level(), node->depth(), node->quantifier(), nestedSet);
+        }
+    } else {
+        std::vector<const NSFNode*> nestedSet;
+        nestedSet.reserve(node->nestedSet().size());
+        for (const NSFNode* n : node->nestedSet()) {
+            nestedSet.push_back(remove(n, variable, vl, memo, avoidedCopies));
+        }
+        result = _store.inner(node->level(), node->depth(), node->quantifier(), nestedSet);
+    }
+    _store.retain(result);
+    memo[node] = result;
+    return result;
+}
+
+/**
+ * Optimizes the children of node and compresses its nested set from the
+ * given side, node is replaced by the result.
+ **/
+bool NodeNSF::optimize(const NSFNode*& node, bool left, NodeMap& memo) {
+    if (node->isLeaf()) {
+        return false;
+    }
+    std::vector<const NSFNode*> nestedSet;
+    nestedSet.reserve(node->nestedSet().size());
+    bool changed = false;
+    for (const NSFNode* n : node->nestedSet()) {
+        const NSFNode* nN = optimize(n, memo);
+        if (nN != n) changed = true;
+        nestedSet.push_back(nN);
+    }
+    int compressed;
+    if (left) {
+        compressed = compressConjunctiveLeft(nestedSet, node);
+    } else {
+        compressed = compressConjunctiveRight(nestedSet, node);
+    }
+    replaceFactor(node, _store.inner(node->level(), node->depth(), node->quantifier(), nestedSet));
+    return changed || compressed > 0;
+}
+
+const NSFNode* NodeNSF::optimize(const NSFNode* node, NodeMap& memo) {
+    if (node->isLeaf()) {
+        _store.retain(node);
+        return node;
+    }
+    NodeMap::const_iterator it = memo.find(node);
+    if (it != memo.end()) {
+        _store.retain(it->second);
+        return it->second;
+    }
+    std::vector<const NSFNode*> nestedSet;
+    nestedSet.reserve(node->nestedSet().size());
+    for (const NSFNode* n : node->nestedSet()) {
+        nestedSet.push_back(optimize(n, memo));
+    }
+    compressConjunctive(nestedSet, node);
+    const NSFNode* result = _store.inner(node->level(), node->depth(), node->quantifier(), nestedSet);
+    _store.retain(result);
+    memo[node] = result;
+    return result;
+}
+
+/**
+ * Subset check that first consults the signatures of both nodes,
+ * which rules out most non-subsumed pairs without a scan.
+ **/
+bool NodeNSF::isSubset(const NSFNode& n1, const NSFNode& n2) const {
+    bool filtered = !n1.maybeSubsetOf(n2);
+    _store.countSubsetCheck(filtered);
+    return !filtered && n1 <= n2;
+}
+
+/**
+ * Adds node to the nested set of parent unless it is subsumed by an element,
+ * in which case its reference is released. Elements subsumed by node are removed.
+ * Subsumption follows compressConjunctive.
+ **/
+void NodeNSF::insertIntoAntichain(std::vector<const NSFNode*>& nestedSet, const NSFNode* node, const NSFNode* parent) const {
+    bool keepSubsets = parent->depth() > 1 || parent->isUniversiallyQuantified();
+    for (const NSFNode* n : nestedSet) {
+        if (keepSubsets ? isSubset(*n, *node) : isSubset(*node, *n)) {
+            _store.release(node);
+            return;
+        }
+    }
+    std::vector<const NSFNode*>::iterator end = std::remove_if(nestedSet.begin(), nestedSet.end(), [&](const NSFNode * n) -> bool {
+        bool subsumed = keepSubsets ? isSubset(*node, *n) : isSubset(*n, *node);
+        if (subsumed) {
+            _store.release(n);
+        }
+        return subsumed;
+    });
+    nestedSet.erase(end, nestedSet.end());
+    nestedSet.push_back(node);
+}
+
+/**
+ * We expect an alternating quantifier sequence!
+ * 
+ **/
+int NodeNSF::compressConjunctive(std::vector<const NSFNode*>& nestedSet, const NSFNode* parent) {
+    int subsetChecksSuccessful = 0;
+
+    std::vector<const NSFNode*>::iterator it1;
+    std::vector<const NSFNode*>::iterator it2;
+    std::vector<const NSFNode*>::iterator end = nestedSet.end();
+
+    for (it1 = nestedSet.begin(); it1 != end;) {
+        const NSFNode* c1 = *it1;
+        bool deleteIt1 = false;
+        it2 = it1;
+        it2++;
+        while (it2 != end) {
+            const NSFNode& c2 = *(*it2);
+            // TODO special handling for innermost quantifier
+            // to be fixed when q-resolution is implemented
+            bool deleteIt2 = false;
+            if (parent->depth() > 1 || parent->isUniversiallyQuantified()) {
+                if (isSubset(*c1, c2)) {
+                    deleteIt2 = true;
+                } else if (isSubset(c2, *c1)) {
+                    deleteIt1 = true;
+                }
+            } else {
+                if (isSubset(c2, *c1)) {
+                    deleteIt2 = true;
+                } else if (isSubset(*c1, c2)) {
+                    deleteIt1 = true;
+                }
+            }
+            if (deleteIt2) {
+                subsetChecksSuccessful++;
+                _store.release(*it2);
+                end--;
+                std::iter_swap(it2, end);
+            } else if (deleteIt1) {
+                subsetChecksSuccessful++;
+                _store.release(*it1);
+                end--;
+                std::iter_swap(it1, end);
+                break;
+            } else {
+                it2++;
+            }
+        }
+        if (!deleteIt1) {
+            it1++;
+        }
+    }
+    nestedSet.resize(end - nestedSet.begin());
+    return subsetChecksSuccessful;
+}
+
+/**
+ * We expect an alternating quantifier sequence!
+ * 
+ **/
+int NodeNSF::compressConjunctiveRight(std::vector<const NSFNode*>& nestedSet, const NSFNode* parent) {
+    int subsetChecksSuccessful = 0;
+
+    std::vector<const NSFNode*>::iterator it1;
+    std::vector<const NSFNode*>::iterator it2;
+    std::vector<const NSFNode*>::iterator end = nestedSet.end();
+
+    for (it1 = nestedSet.begin(); it1 != end;) {
+        const NSFNode* c1 = *it1;
+        bool deleteIt1 = false;
+        it2 = it1;
+        it2++;
+        while (it2 != end) {
+            const NSFNode& c2 = *(*it2);
+            // TODO special handling for innermost quantifier
+            // to be fixed when q-resolution is implemented
+            if (parent->depth() > 1 || parent->isUniversiallyQuantified()) {
+                if (isSubset(c2, *c1)) {
+                    deleteIt1 = true;
+                }
+            } else {
+                if (isSubset(*c1, c2)) {
+                    deleteIt1 = true;
+                }
+            }
+            if (deleteIt1) {
+                subsetChecksSuccessful++;
+                _store.release(*it1);
+                end--;
+                std::iter_swap(it1, end);
+                break;
+            } else {
+                it2++;
+            }
+        }
+        if (!deleteIt1) {
+            it1++;
+        }
+    }
+    nestedSet.resize(end - nestedSet.begin());
+    return subsetChecksSuccessful;
+}
+
+/**
+ * We expect an alternating quantifier sequence!
+ * 
+ **/
+int NodeNSF::compressConjunctiveLeft(std::vector<const NSFNode*>& nestedSet, const NSFNode* parent) {
+    int subsetChecksSuccessful = 0;
+
+    std::vector<const NSFNode*>::iterator it1;
+    std::vector<const NSFNode*>::iterator it2;
+    std::vector<const NSFNode*>::iterator end = nestedSet.end();
+
+    for (it1 = nestedSet.begin(); it1 != end;) {
+        const NSFNode* c1 = *it1;
+        it2 = it1;
+        it2++;
+        while (it2 != end) {
+            const NSFNode& c2 = *(*it2);
+            // TODO special handling for innermost quantifier
+            // to be fixed when q-resolution is implemented
+            bool deleteIt2 = false;
+            if (parent->depth() > 1 || parent->isUniversiallyQuantified()) {
+                if (isSubset(*c1, c2)) {
+                    deleteIt2 = true;
+                }
+            } else {
+                if (isSubset(c2, *c1)) {
+                    deleteIt2 = true;
+                }
+            }
+            if (deleteIt2) {
+                subsetChecksSuccessful++;
+                _store.release(*it2);
+                end--;
+                std::iter_swap(it2, end);
+            } else {
+                it2++;
+            }
+        }
+        it1++;
+    }
+    nestedSet.resize(end - nestedSet.begin());
+    return subsetChecksSuccessful;
+}
+
+BDD NodeNSF::truncate(const NSFNode* node, const std::vector<BDD>& cubesAtlevels) const {
+    BDD ret;
+    if (node->isLeaf()) {
+        ret = node->value();
+    } else {
+        const std::vector<const NSFNode*>& nestedSet = node->nestedSet();
+        ret = truncate(nestedSet.front(), cubesAtlevels);
+        for (unsigned int it = 1; it < nestedSet.size(); it++) {
+            if (node->isExistentiallyQuantified()) {
+                ret += truncate(nestedSet.at(it), cubesAtlevels);
+            } else {
+                ret *= truncate(nestedSet.at(it), cubesAtlevels);
+            }
+        }
+    }
+
+    if (node->isExistentiallyQuantified()) {
+        ret = ret.ExistAbstract(cubesAtlevels[node->level() - 1], 0);
+    } else {
+        ret = ret.UnivAbstract(cubesAtlevels[node->level() - 1]);
+    }
+
+    return ret;
+}
+
+namespace {
+
+    bool increasingBDDsize(const NSFNode* n1, const NSFNode* n2) {
+        return n1->maxBDDsize() < n2->maxBDDsize();
+    }
+}
+
+/**
+ * If given, leaves are replaced by approximate(leaf) and clauses are conjoined
+ * with each leaf, fused with the abstraction of existential leaves.
+ * Results memoized in _evaluated are only reused for nonempty changedVariables.
+ **/
+const BDD NodeNSF::evaluate(const NSFNode* node, const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const BDD* clauses, const std::vector<BDD>& changedVariables, EvaluationMap& evaluated, const unsigned long budget, unsigned long& cost, const std::function<BDD(const BDD&)>* approximate) {
+    EvaluationMap::const_iterator cached = evaluated.find(node);
+    if (cached != evaluated.end()) {
+        return cached->second;
+    }
+    BDD ret;
+    cached = _evaluated.find(node);
+    if (cached != _evaluated.end() && !changedVariables.empty()
+            && node->support() == node->support().ExistAbstract(changedVariables.at(node->level() - 1), 0)) {
+        ret = cached->second;
+    } else {
+        bool abstract = !(node->level() == 1 && keepFirstLevel);
+        const BDD& cube = cubesAtlevels[node->level() - 1];
+        if (node->isLeaf()) {
+            cost += node->maxBDDsize();
+            if (budget > 0 && cost > budget) {
+                return ret;
+            }
+            ret = approximate == NULL ? node->value() : (*approximate)(node->value());
+            if (abstract && clauses != NULL && node->isExistentiallyQuantified()) {
+                ret = ret.AndAbstract(*clauses, cube, 0);
+            } else {
+                if (clauses != NULL) {
+                    ret *= *clauses;
+                }
+                if (abstract) {
+                    if (node->isExistentiallyQuantified()) {
+                        ret = ret.ExistAbstract(cube, 0);
+                    } else {
+                        ret = ret.UnivAbstract(cube);
+                    }
+                }
+            }
+        } else {
+            // cheap children first, they may already decide the nested set
+            std::vector<const NSFNode*> nestedSet(node->nestedSet());
+            std::stable_sort(nestedSet.begin(), nestedSet.end(), increasingBDDsize);
+            bool first = true;
+            for (const NSFNode* n : nestedSet) {
+                BDD value = evaluate(n, cubesAtlevels, keepFirstLevel, clauses, changedVariables, evaluated, budget, cost, approximate);
+                if (budget > 0 && cost > budget) {
+                    return ret;
+                }
+                if (node->isExistentiallyQuantified()) {
+                    if (abstract) {
+                        value = value.ExistAbstract(cube, 0);
+                    }
+                    ret = first ? value : ret + value;
+                    if (ret.IsOne()) {
+                        break;
+                    }
+                } else {
+                    if (abstract) {
+                        value = value.UnivAbstract(cube);
+                    }
+                    ret = first ? value : ret * value;
+                    if (ret.IsZero()) {
+                        break;
+                    }
+                }
+                first = false;
+            }
+        }
+    }
+    _store.retain(node);
+    evaluated[node] = ret;
+    return ret;
+}
+
+bool NodeNSF::isUnsat(const NSFNode* node, const BDD* clauses) const {
+    if (node->isLeaf()) {
+        if (clauses != NULL) {
+            // the leaf is unsat iff it does not intersect the clauses
+            return node->value() <= !(*clauses);
+        }
+        return node->value().IsZero();
+    } else {
+        for (const NSFNode* n : node->nestedSet()) {
+            bool unsatC = isUnsat(n, clauses);
+            if (node->isExistentiallyQuantified() && !unsatC) {
+                return false;
+            } else if (node->isUniversiallyQuantified() && unsatC) {
+                return true;
+            }
+        }
+        if (node->isExistentiallyQuantified()) {
+            return true;
+        } else {
+            return false;
+        }
+    }
+}
+
+void NodeNSF::leavesDependingOn(const NSFNode* node, const BDD& variable, const bool everyLeaf, const unsigned int limit, std::vector<BDD>& leaves, std::unordered_set<const NSFNode*>& visited) const {
+    if ((limit > 0 && leaves.size() >= limit) || !(everyLeaf || node->dependsOn(variable)) || !visited.insert(node).second) {
+        return;
+    }
+    if (node->isLeaf()) {
+        leaves.push_back(node->value());
+        return;
+    }
+    for (const NSFNode* n : node->nestedSet()) {
+        leavesDependingOn(n, variable, everyLeaf, limit, leaves, visited);
+    }
+}
+
+unsigned int NodeNSF::countLeavesDependingOn(const NSFNode* node, const BDD& variable, const bool everyLeaf, std::unordered_set<const NSFNode*>& visited) const {
+    if (!(everyLeaf || node->dependsOn(variable)) || !visited.insert(node).second) {
+        return 0;
+    }
+    if (node->isLeaf()) {
+        return 1;
+    }
+    unsigned int count = 0;
+    for (const NSFNode* n : node->nestedSet()) {
+        count += countLeavesDependingOn(n, variable, everyLeaf, visited);
+    }
+    return count;
+}
+
+/**
+ * Conjuncts all pending factors into the root.
+ **/
+void NodeNSF::materialize() const {
+    for (const NSFNode* factor : _pendingProduct) {
+        NodePairMap memo;
+        const NSFNode* product = conjunct(_root, factor, _pendingAntichain, memo);
+        releaseAll(memo);
+        _store.release(_root);
+        _store.release(factor);
+        _root = product;
+    }
+    _pendingProduct.clear();
+    _pendingAntichain = false;
+}
+
+/**
+ * Conjoins all pending clauses with the leaves of factor (the root or a
+ * factor of a pending product, conjunction distributes over the product).
+ **/
+void NodeNSF::conjoinPendingClauses(const NSFNode*& factor) const {
+    if (_pendingClauses.empty()) {
+        return;
+    }
+    BDD clauses = pendingClauses();
+    _pendingClauses.clear();
+    NodeMap memo;
+    const NSFNode* conjoined = apply(factor, [&clauses](const BDD& bdd) -> BDD {
+        return bdd * clauses;
+    }, memo);
+    releaseAll(memo);
+    replaceFactor(factor, conjoined);
+}
+
+/**
+ * Same as removeAbstract, but conjoins the pending clauses with all leaves
+ * of factor in the same pass. Existential abstraction is fused via AndAbstract,
+ * universal abstraction distributes over the conjunction.
+ **/
+void NodeNSF::abstractPendingClauses(const NSFNode*& factor, const BDD& cube, const unsigned int vl) {
+    NTYPE q = levelQuantifier(factor, vl);
+    BDD clauses = pendingClauses();
+    _pendingClauses.clear();
+    unsigned long nodesBefore = 0;
+    unsigned long nodesAfter = 0;
+    NodeMap memo;
+    if (q == NTYPE::EXISTS) {
+        replaceFactor(factor, apply(factor, [&](const BDD& b) -> BDD {
+            BDD result = b.AndAbstract(clauses, cube, 0);
+            nodesBefore += b.nodeCount();
+            nodesAfter += result.nodeCount();
+            return result;
+        }, memo));
+    } else if (q == NTYPE::FORALL) {
+        BDD abstractedClauses = clauses.UnivAbstract(cube);
+        replaceFactor(factor, apply(factor, [&](const BDD& b) -> BDD {
+            BDD result = b.UnivAbstract(cube) * abstractedClauses;
+            nodesBefore += b.nodeCount();
+            nodesAfter += result.nodeCount();
+            return result;
+        }, memo));
+    } else {
+        // there is no node at level vl
+        replaceFactor(factor, apply(factor, [&clauses](const BDD& b) -> BDD {
+            return b * clauses;
+        }, memo));
+    }
+    releaseAll(memo);
+    if (q != NTYPE::UNKNOWN) {
+        _store.countFusedAbstraction(nodesBefore, nodesAfter);
+    }
+}
+
+bool NodeNSF::pendingClausesDependOn(const BDD& variable) const {
+    for (const BDD& clauses : _pendingClauses) {
+        BDD support = clauses.Support();
+        if (variable.IsVar() ? support <= variable : support.ExistAbstract(variable, 0) != support) {
+            return true;
+        }
+    }
+    return false;
+}
+
+BDD NodeNSF::pendingClauses() const {
+    BDD clauses = _pendingClauses.front();
+    for (unsigned int it = 1; it < _pendingClauses.size(); it++) {
+        clauses *= _pendingClauses.at(it);
+    }
+    return clauses;
+}
+
+/**
+ * Returns the quantifier of the nodes at the given level below node, all of
+ * them share the quantifier of their level.
+ **/
+NTYPE NodeNSF::levelQuantifier(const NSFNode* node, const unsigned int level) const {
+    if (node->level() == level) {
+        return node->quantifier();
+    }
+    for (const NSFNode* n : node->nestedSet()) {
+        NTYPE q = levelQuantifier(n, level);
+        if (q != NTYPE::UNKNOWN) {
+            return q;
+        }
+    }
+    return NTYPE::UNKNOWN;
+}
+
+void NodeNSF::replaceFactor(const NSFNode*& factor, const NSFNode* node) const {
+    _store.release(factor);
+    factor = node;
+}
+
+std::vector<const NSFNode**> NodeNSF::factors() const {
+    std::vector<const NSFNode**> factors(1, &_root);
+    for (const NSFNode*& factor : _pendingProduct) {
+        factors.push_back(&factor);
+    }
+    return factors;
+}
+
+/**
+ * Returns the factor of a pending product (the root included) that is the
+ * only one whose leaves depend on variables, the root if none does, and NULL
+ * if several do. In the first two cases, abstracting or splitting variables
+ * (along with conjoining the pending clauses) can be applied to this factor
+ * alone, since the other factors are not affected.
+ **/
+const NSFNode** NodeNSF::dependentFactor(const BDD& variables) const {
+    const NSFNode** dependent = NULL;
+    for (const NSFNode** factor : factors()) {
+        if ((*factor)->dependsOn(variables)) {
+            if (dependent != NULL) {
+                return NULL;
+            }
+            dependent = factor;
+        }
+    }
+    return dependent == NULL ? &_root : dependent;
+}
+
+void NodeNSF::releaseAll(NodeMap& memo) const {
+    for (const auto& entry : memo) {
+        _store.release(entry.second);
+    }
+    memo.clear();
+}
+
+void NodeNSF::releaseAll(NodePairMap& memo) const {
+    for (const auto& entry : memo) {
+        _store.release(entry.second);
+    }
+    memo.clear();
+}
+
+void NodeNSF::releaseAll(EvaluationMap& memo) const {
+    for (const auto& entry : memo) {
+        _store.release(entry.first);
+    }
+    memo.clear();
+}
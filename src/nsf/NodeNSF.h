@@ -0,0 +1,170 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include <iostream>
+#include <set>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+
+#include "cuddObj.hh"
+#include "htd/main.hpp"
+
+#include "../BDDManager.h"
+#include "../Instance.h"
+#include "NSF.h"
+#include "NSFNode.h"
+#include "NSFNodeStore.h"
+
+/**
+ * NSF whose nested set is a DAG of immutable, hash-consed NSFNodes (see NSFNodeStore).
+ * 
+ * Copying an NSF is O(1), and modifying operations replace the root node,
+ * sharing all unchanged subtrees with other NSFs.
+ * 
+ * A conjunction may be kept pending as a factored product of root nodes. The
+ * product is only materialized once an operation needs the nested sets.
+ * Likewise, clauses may be kept pending for all leaves. They are conjoined into
+ * the leaves once these are abstracted (fused via AndAbstract where possible)
+ * or compared, evaluation conjoins them on the fly. Leaves may be minimized
+ * with the pending clauses as care set.
+ * 
+ * Conjunctions can be computed as antichains: each product element is only
+ * kept if it is not subsumed, and it removes all elements it subsumes.
+ * 
+ * Evaluation results are memoized per node and reused by the next evaluation
+ * for all nodes whose support does not contain a variable whose cube changed.
+ * Children are evaluated by increasing BDD size and evaluation of a nested set
+ * stops as soon as one child decides it.
+ **/
+class NodeNSF : public NSF {
+public:
+    NodeNSF(NSFNodeStore& store, const std::vector<NTYPE>& quantifierSequence, const BDD& bdd);
+    NodeNSF(const NodeNSF& other);
+    virtual ~NodeNSF();
+
+    virtual NSF* copy() const override;
+
+    virtual bool operator==(const NSF& other) const override;
+    virtual bool operator!=(const NSF& other) const override;
+    virtual bool operator<=(const NSF& other) const override;
+
+    const NSFNode* root() const;
+
+    virtual unsigned int depth() const override;
+    virtual unsigned int level() const override;
+    virtual NTYPE quantifier() const override;
+
+    virtual const unsigned int maxBDDsize() const override;
+    virtual const unsigned int leavesCount() const override;
+    virtual const unsigned int nsfCount() const override;
+
+    virtual void print(bool verbose = false) const override;
+
+    virtual void apply(const std::function<BDD(const BDD&)>& f) override;
+    virtual void apply(const BDD& clauses) override;
+    virtual void applyLazily(const BDD& clauses) override;
+    virtual void applyAbstract(const BDD& clauses, const BDD& cube, const unsigned int vl) override;
+
+    virtual void conjunct(const NSF& other, bool antichain) override;
+    virtual void conjunctLazily(const NSF& other, bool antichain) override;
+    virtual bool hasPendingProduct() const override;
+
+    virtual void removeAbstract(const BDD& variable, const unsigned int vl) override;
+    
+    using NSF::remove;
+    virtual unsigned int remove(const BDD& variable, const unsigned int vl) override;
+
+    virtual BDD truncate(const std::vector<BDD>& cubesAtlevels) override;
+    virtual const BDD evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel) override;
+    virtual const BDD evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) override;
+    virtual const BDD evaluateApproximation(const std::vector<BDD>& cubesAtlevels, const std::function<BDD(const BDD&)>& approximate, const bool upperBound, bool& bounded) override;
+    virtual bool isUnsat() const override;
+    virtual std::vector<BDD> leavesDependingOn(const BDD& variable, const unsigned int limit) const override;
+    virtual unsigned int countLeavesDependingOn(const BDD& variable) const override;
+
+    virtual bool optimize() override;
+    virtual bool optimize(bool left) override;
+    virtual void minimize(const std::function<BDD(const BDD&, const BDD&)>& minimizer) override;
+
+protected:
+    typedef std::unordered_map<const NSFNode*, const NSFNode*> NodeMap;
+    typedef std::map<std::pair<const NSFNode*, const NSFNode*>, const NSFNode*> NodePairMap;
+    typedef std::unordered_map<const NSFNode*, BDD> EvaluationMap;
+
+    // traversals are instantiated per leaf operation, such that it can be inlined
+    template <typename LeafOperation>
+    const NSFNode* apply(const NSFNode* node, const LeafOperation& f, NodeMap& memo) const;
+    template <typename LeafOperation>
+    const NSFNode* apply(const NSFNode* node, const BDD& variable, const LeafOperation& f, NodeMap& memo) const;
+    const NSFNode* conjunct(const NSFNode* n1, const NSFNode* n2, bool antichain, NodePairMap& memo) const;
+    const NSFNode* removeAbstract(const NSFNode* node, const BDD& variable, const unsigned int vl, NodeMap& memo);
+    const NSFNode* remove(const NSFNode* node, const BDD& variable, const unsigned int vl, NodeMap& memo, unsigned int& avoidedCopies);
+    const NSFNode* optimize(const NSFNode* node, NodeMap& memo);
+    bool optimize(const NSFNode*& node, bool left, NodeMap& memo);
+
+    BDD truncate(const NSFNode* node, const std::vector<BDD>& cubesAtlevels) const;
+    const BDD evaluate(const NSFNode* node, const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const BDD* clauses, const std::vector<BDD>& changedVariables, EvaluationMap& evaluated, const unsigned long budget, unsigned long& cost, const std::function<BDD(const BDD&)>* approximate = NULL);
+    bool isUnsat(const NSFNode* node, const BDD* clauses) const;
+    const BDD refute(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget);
+    void leavesDependingOn(const NSFNode* node, const BDD& variable, const bool everyLeaf, const unsigned int limit, std::vector<BDD>& leaves, std::unordered_set<const NSFNode*>& visited) const;
+    unsigned int countLeavesDependingOn(const NSFNode* node, const BDD& variable, const bool everyLeaf, std::unordered_set<const NSFNode*>& visited) const;
+    NTYPE levelQuantifier(const NSFNode* node, const unsigned int level) const;
+
+    bool isSubset(const NSFNode& n1, const NSFNode& n2) const;
+    void insertIntoAntichain(std::vector<const NSFNode*>& nestedSet, const NSFNode* node, const NSFNode* parent) const;
+    int compressConjunctive(std::vector<const NSFNode*>& nestedSet, const NSFNode* parent);
+    int compressConjunctiveLeft(std::vector<const NSFNode*>& nestedSet, const NSFNode* parent);
+    int compressConjunctiveRight(std::vector<const NSFNode*>& nestedSet, const NSFNode* parent);
+
+    NSFNodeStore& _store;
+
+private:
+    void materialize() const;
+    void conjoinPendingClauses(const NSFNode*& factor) const;
+    void abstractPendingClauses(const NSFNode*& factor, const BDD& cube, const unsigned int vl);
+    bool pendingClausesDependOn(const BDD& variable) const;
+    BDD pendingClauses() const;
+    void replaceFactor(const NSFNode*& factor, const NSFNode* node) const;
+    std::vector<const NSFNode**> factors() const;
+    const NSFNode** dependentFactor(const BDD& variables) const;
+    void releaseAll(NodeMap& memo) const;
+    void releaseAll(NodePairMap& memo) const;
+    void releaseAll(EvaluationMap& memo) const;
+
+    mutable const NSFNode* _root;
+    // factors that still have to be conjuncted with _root
+    mutable std::vector<const NSFNode*> _pendingProduct;
+    mutable bool _pendingAntichain;
+    // clauses that still have to be conjoined with all leaves
+    mutable std::vector<BDD> _pendingClauses;
+
+    // results of the last evaluation
+    EvaluationMap _evaluated;
+    std::vector<BDD> _evaluatedCubes;
+    std::vector<BDD> _evaluatedClauses;
+    bool _evaluatedKeepFirstLevel;
+};
+
@@ -0,0 +1,234 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <iostream>
+#include <unordered_map>
+
+#include "PackedNSF.h"
+
+PackedNSF::PackedNSF(NSFNodeStore& store, const std::vector<NTYPE>& quantifierSequence, const BDD& bdd) :
+NodeNSF(store, quantifierSequence, bdd),
+_packedRoot(NULL),
+_rootLevel(0) {
+}
+
+PackedNSF::PackedNSF(const PackedNSF& other) :
+NodeNSF(other),
+_packedRoot(NULL),
+_rootLevel(0) {
+}
+
+PackedNSF::~PackedNSF() {
+    if (_packedRoot != NULL) {
+        _store.release(_packedRoot);
+    }
+}
+
+NSF* PackedNSF::copy() const {
+    return new PackedNSF(*this);
+}
+
+void PackedNSF::print(bool verbose) const {
+    pack();
+    print(0, 0, verbose);
+}
+
+/**
+ * Evaluates the rows bottom-up. Each distinct node is evaluated exactly once,
+ * nested sets stop combining as soon as their value is decided.
+ **/
+const BDD PackedNSF::evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) {
+    if (hasPendingProduct()) {
+        // packing would materialize the product, exact evaluations materialize it before
+        return refute(cubesAtlevels, keepFirstLevel, budget, withinBudget);
+    }
+    pack();
+    unsigned int row = _children.size();
+    unsigned int level = _rootLevel + row;
+    bool abstract = !(level == 1 && keepFirstLevel);
+    const BDD& leafCube = cubesAtlevels[level - 1];
+    unsigned long cost = 0;
+    std::vector<BDD> values(_leaves.size());
+    for (unsigned int i = 0; i < _leaves.size(); i++) {
+        cost += _leafSizes[i];
+        if (budget > 0 && cost > budget) {
+            withinBudget = false;
+            return BDD();
+        }
+        values[i] = _leaves[i];
+        if (abstract) {
+            if (_quantifiers[row] == NTYPE::EXISTS) {
+                values[i] = values[i].ExistAbstract(leafCube, 0);
+            } else {
+                values[i] = values[i].UnivAbstract(leafCube);
+            }
+        }
+    }
+    while (row > 0) {
+        row--;
+        level--;
+        abstract = !(level == 1 && keepFirstLevel);
+        const BDD& cube = cubesAtlevels[level - 1];
+        const std::vector<unsigned int>& offsets = _offsets[row];
+        const std::vector<unsigned int>& children = _children[row];
+        std::vector<BDD> rowValues(offsets.size() - 1);
+        for (unsigned int i = 0; i + 1 < offsets.size(); i++) {
+            BDD ret;
+            for (unsigned int c = offsets[i]; c < offsets[i + 1]; c++) {
+                BDD value = values[children[c]];
+                if (_quantifiers[row] == NTYPE::EXISTS) {
+                    if (abstract) {
+                        value = value.ExistAbstract(cube, 0);
+                    }
+                    ret = c == offsets[i] ? value : ret + value;
+                    if (ret.IsOne()) {
+                        break;
+                    }
+                } else {
+                    if (abstract) {
+                        value = value.UnivAbstract(cube);
+                    }
+                    ret = c == offsets[i] ? value : ret * value;
+                    if (ret.IsZero()) {
+                        break;
+                    }
+                }
+            }
+            rowValues[i] = ret;
+        }
+        values.swap(rowValues);
+    }
+    withinBudget = true;
+    return values.front();
+}
+
+bool PackedNSF::isUnsat() const {
+    if (hasPendingProduct()) {
+        // factors are checked before the product is materialized
+        return NodeNSF::isUnsat();
+    }
+    pack();
+    std::vector<bool> unsat(_leaves.size());
+    for (unsigned int i = 0; i < _leaves.size(); i++) {
+        unsat[i] = _leaves[i].IsZero();
+    }
+    for (unsigned int row = _children.size(); row > 0; row--) {
+        const std::vector<unsigned int>& offsets = _offsets[row - 1];
+        const std::vector<unsigned int>& children = _children[row - 1];
+        bool existential = _quantifiers[row - 1] == NTYPE::EXISTS;
+        std::vector<bool> rowUnsat(offsets.size() - 1, existential);
+        for (unsigned int i = 0; i + 1 < offsets.size(); i++) {
+            for (unsigned int c = offsets[i]; c < offsets[i + 1]; c++) {
+                if (unsat[children[c]] != existential) {
+                    rowUnsat[i] = !existential;
+                    break;
+                }
+            }
+        }
+        unsat.swap(rowUnsat);
+    }
+    return unsat.front();
+}
+
+/**
+ * Rebuilds the layout, unless it was built from the current root. Nodes
+ * shared within the DAG get a single index in their row.
+ **/
+void PackedNSF::pack() const {
+    const NSFNode* current = root();
+    if (current == _packedRoot) {
+        return;
+    }
+    _store.retain(current);
+    if (_packedRoot != NULL) {
+        _store.release(_packedRoot);
+    }
+    _packedRoot = current;
+    _rootLevel = current->level();
+
+    unsigned int rows = current->depth();
+    _quantifiers.resize(rows + 1);
+    _offsets.resize(rows);
+    _children.resize(rows);
+    std::vector<const NSFNode*> nodes(1, current);
+    for (unsigned int row = 0; row < rows; row++) {
+        if (!nodes.empty()) {
+            _quantifiers[row] = nodes.front()->quantifier();
+        }
+        std::vector<unsigned int>& offsets = _offsets[row];
+        std::vector<unsigned int>& children = _children[row];
+        offsets.assign(1, 0);
+        children.clear();
+        std::unordered_map<const NSFNode*, unsigned int> indices;
+        std::vector<const NSFNode*> next;
+        for (const NSFNode* node : nodes) {
+            for (const NSFNode* child : node->nestedSet()) {
+                auto inserted = indices.emplace(child, next.size());
+                if (inserted.second) {
+                    next.push_back(child);
+                }
+                children.push_back(inserted.first->second);
+            }
+            offsets.push_back(children.size());
+        }
+        nodes.swap(next);
+    }
+    _leaves.clear();
+    _leafSizes.clear();
+    if (!nodes.empty()) {
+        _quantifiers[rows] = nodes.front()->quantifier();
+    }
+    for (const NSFNode* leaf : nodes) {
+        _leaves.push_back(leaf->value());
+        _leafSizes.push_back(leaf->maxBDDsize());
+    }
+}
+
+void PackedNSF::print(unsigned int row, unsigned int index, bool verbose) const {
+    if (verbose) {
+        if (_quantifiers[row] == NTYPE::EXISTS) std::cout << "E";
+        else if (_quantifiers[row] == NTYPE::FORALL) std::cout << "A";
+        else std::cout << "U";
+        std::cout << " l" << (_rootLevel + row);
+        std::cout << " d" << (_children.size() - row) << " ";
+    }
+    if (row == _children.size()) {
+        const BDD& value = _leaves[index];
+        if (value.IsZero()) {
+            std::cout << "[B]";
+        } else if (value.IsOne()) {
+            std::cout << "[T]";
+        } else {
+            std::cout << "[" << _leafSizes[index] << "]";
+            if (verbose) {
+                std::cout << std::endl;
+                value.print(0, 2);
+                std::cout << std::endl;
+            }
+        }
+    } else {
+        std::cout << "{";
+        for (unsigned int c = _offsets[row][index]; c < _offsets[row][index + 1]; c++) {
+            print(row + 1, _children[row][c], verbose);
+        }
+        std::cout << "}";
+    }
+}
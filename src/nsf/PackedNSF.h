@@ -0,0 +1,70 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "NodeNSF.h"
+
+/**
+ * NSF that additionally keeps its nested sets in a structure-of-arrays layout.
+ * 
+ * Row r holds the distinct nodes at distance r from the root: children of the
+ * i-th node of an inner row are the indices children[offsets[i]] to
+ * children[offsets[i + 1] - 1] of the next row (compressed sparse rows), and the
+ * last row is a single array of leaf BDDs. Evaluation, unsat checks and
+ * printing are sweeps over these arrays instead of traversals of the DAG.
+ * 
+ * All modifying operations are inherited, the layout is rebuilt from the
+ * current root on first use after a change. The arrays are a read-only
+ * snapshot, not the primary storage: during solving the NSF changes in every
+ * step, so every step pays for one walk over the DAG (with one hash lookup per
+ * edge) before the sweeps can start. This pays off only if the layout is
+ * read several times per step, e.g. by evaluation and the unsat check.
+ **/
+class PackedNSF : public NodeNSF {
+public:
+    PackedNSF(NSFNodeStore& store, const std::vector<NTYPE>& quantifierSequence, const BDD& bdd);
+    PackedNSF(const PackedNSF& other);
+    virtual ~PackedNSF();
+
+    virtual NSF* copy() const override;
+
+    virtual void print(bool verbose = false) const override;
+
+    using NodeNSF::evaluate;
+    virtual const BDD evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) override;
+    virtual bool isUnsat() const override;
+
+private:
+    void pack() const;
+    void print(unsigned int row, unsigned int index, bool verbose) const;
+
+    // root the layout was built from, retained such that it cannot be reused
+    mutable const NSFNode* _packedRoot;
+    mutable unsigned int _rootLevel;
+    mutable std::vector<NTYPE> _quantifiers;
+    mutable std::vector<std::vector<unsigned int>> _offsets;
+    mutable std::vector<std::vector<unsigned int>> _children;
+    mutable std::vector<BDD> _leaves;
+    mutable std::vector<unsigned int> _leafSizes;
+};
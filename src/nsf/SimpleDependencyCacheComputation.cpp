@@ -39,8 +39,8 @@ SimpleDependencyCacheComputation::SimpleDependencyCacheComputation(const SimpleD
 SimpleDependencyCacheComputation::~SimpleDependencyCacheComputation() {
 }
 
-void SimpleDependencyCacheComputation::conjunct(const Computation& other) {
-    CacheComputation::conjunct(other);
+void SimpleDependencyCacheComputation::conjunct(const Computation& other, bool lazy) {
+    CacheComputation::conjunct(other, lazy);
     try {
         // check if other contains a remove cache
         const SimpleDependencyCacheComputation& t = dynamic_cast<const SimpleDependencyCacheComputation&> (other);
@@ -55,7 +55,7 @@ bool SimpleDependencyCacheComputation::reduceRemoveCache() {
     if (isRemoveCacheReducible()) {
         for (unsigned int vl = _removeCache->size(); vl >= 1; vl--) {
             if (isRemovableAtRemoveCacheLevel(vl)) {
-                BDD toRemove = popFirstFromRemoveCache(vl); // simulate fifo
+                BDD toRemove = selectFromRemoveCache(vl);
 
                 bool abstractable = isAbstractableAtLevel(vl);
                 if (abstractable) {
@@ -73,7 +73,7 @@ bool SimpleDependencyCacheComputation::reduceRemoveCache() {
 
 void SimpleDependencyCacheComputation::addToRemoveCache(BDD variable, const unsigned int vl) {
     if (isAbstractableAtLevel(vl)) {
-        Computation::removeAbstract(variable, vl);
+        abstractBatched(variable, vl);
         _completelyRemovedCountAtLevel.at(vl - 1) += 1;
         return;
     }
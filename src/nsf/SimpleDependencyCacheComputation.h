@@ -32,7 +32,7 @@ public:
 
     ~SimpleDependencyCacheComputation();
     
-    virtual void conjunct(const Computation& other) override;
+    virtual void conjunct(const Computation& other, bool lazy) override;
 
 protected:
     bool reduceRemoveCache() override;
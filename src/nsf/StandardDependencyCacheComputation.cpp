@@ -22,46 +22,31 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <iterator>
 
 #include "StandardDependencyCacheComputation.h"
 #include "cuddInt.h"
 
-StandardDependencyCacheComputation::StandardDependencyCacheComputation(ComputationManager& manager, const std::vector<NTYPE>& quantifierSequence, const std::vector<BDD>& cubesAtLevels, const BDD& bdd, unsigned int maxBDDsize, bool keepFirstLevel, QDPLL& depqbf, std::vector<unsigned int>& cuddToOriginalIds, std::vector<std::set<htd::vertex_t>>&notYetRemovedAtLevels)
+StandardDependencyCacheComputation::StandardDependencyCacheComputation(ComputationManager& manager, const std::vector<NTYPE>& quantifierSequence, const std::vector<BDD>& cubesAtLevels, const BDD& bdd, unsigned int maxBDDsize, bool keepFirstLevel, std::vector<unsigned int>& cuddToOriginalIds, const std::vector<VertexBitset>& notYetRemovedAtLevels)
 : CacheComputation(manager, quantifierSequence, cubesAtLevels, bdd, maxBDDsize, keepFirstLevel)
-, _depqbf(depqbf)
 , _cuddToOriginalIds(cuddToOriginalIds)
 , _notYetRemovedAtLevels(notYetRemovedAtLevels) {
 }
 
 StandardDependencyCacheComputation::StandardDependencyCacheComputation(const StandardDependencyCacheComputation& other)
 : CacheComputation(other)
-, _depqbf(other._depqbf)
-, _cuddToOriginalIds(other._cuddToOriginalIds) {
-    for (std::set<htd::vertex_t> otherNotYetRemoved : other._notYetRemovedAtLevels) {
-        std::set<htd::vertex_t> thisNotYestRemoved(otherNotYetRemoved);
-        _notYetRemovedAtLevels.push_back(thisNotYestRemoved);
-    }
+, _cuddToOriginalIds(other._cuddToOriginalIds)
+, _notYetRemovedAtLevels(other._notYetRemovedAtLevels) {
 }
 
 StandardDependencyCacheComputation::~StandardDependencyCacheComputation() {
 }
 
-void StandardDependencyCacheComputation::conjunct(const Computation& other) {
-    CacheComputation::conjunct(other);
+void StandardDependencyCacheComputation::conjunct(const Computation& other, bool lazy) {
+    CacheComputation::conjunct(other, lazy);
     try {
         const StandardDependencyCacheComputation& t = dynamic_cast<const StandardDependencyCacheComputation&> (other);
         for (unsigned int i = 0; i < t._notYetRemovedAtLevels.size(); i++) {
-
-            std::set<htd::vertex_t> own = _notYetRemovedAtLevels.at(i);
-            std::set<htd::vertex_t> other = t._notYetRemovedAtLevels.at(i);
-            std::set<htd::vertex_t> target;
-
-            std::set_intersection(own.begin(), own.end(),
-                    other.begin(), other.end(),
-                    std::inserter(target, target.begin()));
-
-            _notYetRemovedAtLevels.at(i) = target;
+            _notYetRemovedAtLevels.at(i) &= t._notYetRemovedAtLevels.at(i);
         }
     } catch (std::bad_cast exp) {
     }
@@ -71,20 +56,15 @@ bool StandardDependencyCacheComputation::reduceRemoveCache() {
     if (isRemoveCacheReducible()) {
         for (unsigned int vl = _removeCache->size(); vl >= 1; vl--) {
             if (isRemovableAtRemoveCacheLevel(vl)) {
-                BDD toRemove = popFirstFromRemoveCache(vl); // simulate fifo
+                BDD toRemove = selectFromRemoveCache(vl);
                 unsigned int removedOriginalId = _cuddToOriginalIds.at(toRemove.getRegularNode()->index);
 
                 bool dependent = false;
                 unsigned int independentUntilLevel = vl;
 
                 for (unsigned int level = vl + 1; level <= _notYetRemovedAtLevels.size(); level++) {
-                    for (htd::vertex_t notYetRemoved : _notYetRemovedAtLevels.at(level - 1)) {
-                        if (qdpll_var_depends(&_depqbf, removedOriginalId, notYetRemoved)) {
-                            dependent = true;
-                            break;
-                        }
-                    }
-                    if (dependent) {
+                    if (dependsOnNotYetRemoved(removedOriginalId, level)) {
+                        dependent = true;
                         break;
                     } else {
                         independentUntilLevel = level;
@@ -118,20 +98,15 @@ void StandardDependencyCacheComputation::addToRemoveCache(BDD variable, const un
 
     bool dependent = false;
     for (unsigned int level = vl + 1; level <= _notYetRemovedAtLevels.size(); level++) {
-        for (htd::vertex_t notYetRemoved : _notYetRemovedAtLevels.at(level - 1)) {
-            if (qdpll_var_depends(&_depqbf, removedOriginalId, notYetRemoved)) {
-                dependent = true;
-                break;
-            }
-        }
-        if (dependent) {
+        if (dependsOnNotYetRemoved(removedOriginalId, level)) {
+            dependent = true;
             break;
         }
     }
     
     // TODO: only if we do not enumerate or level > 1!
     if (!dependent && !(_keepFirstLevel && vl == 1)) {
-        Computation::removeAbstract(variable, vl);
+        abstractBatched(variable, vl);
         _notYetRemovedAtLevels.at(vl - 1).erase(removedOriginalId);
         return;
     }
@@ -147,7 +122,11 @@ void StandardDependencyCacheComputation::addToRemoveCache(BDD variable, const un
 void StandardDependencyCacheComputation::print(bool verbose) const {
     std::cout << "Not yet removed at levels (size):" << std::endl;
     for (unsigned int level = 1; level <= _notYetRemovedAtLevels.size(); level++) {
-        std::cout << level << ": " << _notYetRemovedAtLevels.at(level - 1).size() << std::endl;
+        std::cout << level << ": " << _notYetRemovedAtLevels.at(level - 1).count() << std::endl;
     }
     CacheComputation::print(verbose);
 }
+
+bool StandardDependencyCacheComputation::dependsOnNotYetRemoved(const htd::vertex_t vertex, const unsigned int level) const {
+    return manager.dependencies(vertex).intersects(_notYetRemovedAtLevels.at(level - 1));
+}
@@ -23,20 +23,16 @@ along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
 #include "NSF.h"
 #include "CacheComputation.h"
 #include "ComputationManager.h"
-
-extern "C" 
-{
-#include "qdpll.h"
-}
+#include "VertexBitset.h"
 
 class StandardDependencyCacheComputation : public CacheComputation {
 public:
-    StandardDependencyCacheComputation(ComputationManager& manager, const std::vector<NTYPE>& quantifierSequence, const std::vector<BDD>& cubesAtLevels, const BDD& bdd, unsigned int maxBDDsize, bool keepFirstLevel, QDPLL& depqbf, std::vector<unsigned int>& cuddToOriginalIds, std::vector<std::set<htd::vertex_t>>& notYetRemovedAtLevels);
+    StandardDependencyCacheComputation(ComputationManager& manager, const std::vector<NTYPE>& quantifierSequence, const std::vector<BDD>& cubesAtLevels, const BDD& bdd, unsigned int maxBDDsize, bool keepFirstLevel, std::vector<unsigned int>& cuddToOriginalIds, const std::vector<VertexBitset>& notYetRemovedAtLevels);
     StandardDependencyCacheComputation(const StandardDependencyCacheComputation& other);
 
     ~StandardDependencyCacheComputation();
 
-    virtual void conjunct(const Computation& other) override;
+    virtual void conjunct(const Computation& other, bool lazy) override;
     
     virtual void print(bool verbose) const override;
     
@@ -45,10 +41,10 @@ protected:
     void addToRemoveCache(BDD variable, const unsigned int vl) override;
 
 private:
+    bool dependsOnNotYetRemoved(const htd::vertex_t vertex, const unsigned int level) const;
     
-    QDPLL& _depqbf;
     std::vector<unsigned int>& _cuddToOriginalIds;
     
-    std::vector<std::set<htd::vertex_t>> _notYetRemovedAtLevels;
+    std::vector<VertexBitset> _notYetRemovedAtLevels;
     
 };
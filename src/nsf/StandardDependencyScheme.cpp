@@ -0,0 +1,125 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "StandardDependencyScheme.h"
+
+StandardDependencyScheme::StandardDependencyScheme(const Instance& instance)
+: _quantifierSequence(instance.getQuantifierSequence()) {
+    htd::vertex_t size = 1;
+    for (htd::vertex_t vertex : instance.hypergraph->internalGraph().vertices()) {
+        if (vertex >= size) {
+            size = vertex + 1;
+        }
+    }
+    _vertexLevels.resize(size, 0);
+    for (htd::vertex_t vertex : instance.hypergraph->internalGraph().vertices()) {
+        _vertexLevels.at(vertex) = htd::accessLabel<int>(instance.hypergraph->internalGraph().vertexLabel("level", vertex));
+    }
+    std::vector<std::vector<htd::vertex_t>> clauses;
+    for (const htd::Hyperedge& edge : instance.hypergraph->internalGraph().hyperedges()) {
+        clauses.push_back(std::vector<htd::vertex_t>(edge.begin(), edge.end()));
+    }
+    initialize(clauses);
+}
+
+StandardDependencyScheme::StandardDependencyScheme(const std::vector<NTYPE>& quantifierSequence, const std::vector<unsigned int>& vertexLevels, const std::vector<std::vector<htd::vertex_t>>& clauses)
+: _quantifierSequence(quantifierSequence)
+, _vertexLevels(vertexLevels) {
+    initialize(clauses);
+}
+
+void StandardDependencyScheme::initialize(const std::vector<std::vector<htd::vertex_t>>& clauses) {
+    _clausesOfVertex.resize(_vertexLevels.size());
+    std::vector<std::vector<htd::vertex_t>> verticesAtLevels(_quantifierSequence.size());
+    for (htd::vertex_t vertex = 1; vertex < _vertexLevels.size(); vertex++) {
+        if (_vertexLevels.at(vertex) > 0) {
+            verticesAtLevels.at(_vertexLevels.at(vertex) - 1).push_back(vertex);
+        }
+    }
+
+    unsigned int clauseCount = clauses.size();
+    for (unsigned int clause = 0; clause < clauseCount; clause++) {
+        for (htd::vertex_t vertex : clauses.at(clause)) {
+            _clausesOfVertex.at(vertex).push_back(clause);
+        }
+    }
+
+    // add existential variables from the innermost level outwards
+    std::vector<unsigned int> parents(clauseCount);
+    for (unsigned int clause = 0; clause < clauseCount; clause++) {
+        parents[clause] = clause;
+    }
+    _componentsAtLevels.resize(_quantifierSequence.size());
+    for (unsigned int level = _quantifierSequence.size(); level >= 1; level--) {
+        std::vector<unsigned int>& components = _componentsAtLevels.at(level - 1);
+        components.resize(clauseCount);
+        for (unsigned int clause = 0; clause < clauseCount; clause++) {
+            components[clause] = find(parents, clause);
+        }
+        if (_quantifierSequence.at(level - 1) != NTYPE::EXISTS) {
+            continue;
+        }
+        for (htd::vertex_t vertex : verticesAtLevels.at(level - 1)) {
+            const std::vector<unsigned int>& clauses = _clausesOfVertex.at(vertex);
+            for (unsigned int it = 1; it < clauses.size(); it++) {
+                unsigned int root = find(parents, clauses[0]);
+                unsigned int other = find(parents, clauses[it]);
+                if (root != other) {
+                    parents[other] = root;
+                }
+            }
+        }
+    }
+}
+
+void StandardDependencyScheme::addDependencies(const htd::vertex_t vertex, VertexBitset& dependencies) const {
+    unsigned int vertexLevel = _vertexLevels.at(vertex);
+    if (vertexLevel == 0) {
+        return;
+    }
+    const std::vector<unsigned int>& components = _componentsAtLevels.at(vertexLevel - 1);
+    std::vector<bool> connected(components.size(), false);
+    for (unsigned int clause : _clausesOfVertex.at(vertex)) {
+        connected[components[clause]] = true;
+    }
+    NTYPE quantifier = _quantifierSequence.at(vertexLevel - 1);
+    for (htd::vertex_t other = 1; other < _vertexLevels.size(); other++) {
+        unsigned int otherLevel = _vertexLevels.at(other);
+        if (otherLevel <= vertexLevel || _quantifierSequence.at(otherLevel - 1) == quantifier) {
+            continue;
+        }
+        for (unsigned int clause : _clausesOfVertex.at(other)) {
+            if (connected[components[clause]]) {
+                dependencies.insert(other);
+                break;
+            }
+        }
+    }
+}
+
+unsigned int StandardDependencyScheme::find(std::vector<unsigned int>& parents, unsigned int clause) {
+    while (parents[clause] != clause) {
+        parents[clause] = parents[parents[clause]];
+        clause = parents[clause];
+    }
+    return clause;
+}
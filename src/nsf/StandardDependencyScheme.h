@@ -0,0 +1,56 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "../Instance.h"
+#include "VertexBitset.h"
+
+/**
+ * Standard dependency scheme computed from the clause graph: a variable of an
+ * inner level depends on a variable x of the other quantifier if both occur
+ * in clauses that are connected via existential variables right of x.
+ * Connectivity is determined by union-find over the clauses, one snapshot of
+ * the components is kept per quantifier level.
+ **/
+class StandardDependencyScheme {
+public:
+    StandardDependencyScheme(const Instance& instance);
+    // vertexLevels is indexed by vertex id (0 for unused ids), clauses contain vertex ids
+    StandardDependencyScheme(const std::vector<NTYPE>& quantifierSequence, const std::vector<unsigned int>& vertexLevels, const std::vector<std::vector<htd::vertex_t>>& clauses);
+
+    // inserts the variables of inner levels that depend on vertex
+    void addDependencies(const htd::vertex_t vertex, VertexBitset& dependencies) const;
+
+private:
+    void initialize(const std::vector<std::vector<htd::vertex_t>>& clauses);
+    static unsigned int find(std::vector<unsigned int>& parents, unsigned int clause);
+
+    std::vector<NTYPE> _quantifierSequence;
+    std::vector<unsigned int> _vertexLevels;
+    std::vector<std::vector<unsigned int>> _clausesOfVertex;
+
+    // component of each clause when connecting via existential variables of levels > level
+    std::vector<std::vector<unsigned int>> _componentsAtLevels;
+};
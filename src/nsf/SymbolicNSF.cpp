@@ -0,0 +1,512 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <map>
+
+#include "SymbolicNSF.h"
+#include "ComputationManager.h"
+
+namespace {
+
+    bool nodeOrder(const BDD& b1, const BDD& b2) {
+        return b1.getNode() < b2.getNode();
+    }
+}
+
+SymbolicNSF::SymbolicNSF(NSFNodeStore& store, ComputationManager& manager, const Cudd& bddManager, const std::vector<NTYPE>& quantifierSequence, const BDD& bdd) :
+_store(store),
+_manager(manager),
+_bddManager(bddManager),
+_outerQuantifier(quantifierSequence.at(0)),
+_innerQuantifier(quantifierSequence.at(1)),
+_set(bdd),
+_indexBits(0),
+_size(1),
+_maxBDDsize(0),
+_maxBDDsizeValid(false) {
+}
+
+SymbolicNSF::SymbolicNSF(const SymbolicNSF& other) :
+_store(other._store),
+_manager(other._manager),
+_bddManager(other._bddManager),
+_outerQuantifier(other._outerQuantifier),
+_innerQuantifier(other._innerQuantifier),
+_set(other._set),
+_indexBits(other._indexBits),
+_size(other._size),
+_maxBDDsize(other._maxBDDsize),
+_maxBDDsizeValid(other._maxBDDsizeValid) {
+}
+
+SymbolicNSF::~SymbolicNSF() {
+}
+
+NSF* SymbolicNSF::copy() const {
+    return new SymbolicNSF(*this);
+}
+
+bool SymbolicNSF::operator==(const NSF& other) const {
+    const SymbolicNSF* o = dynamic_cast<const SymbolicNSF*> (&other);
+    if (o == NULL) {
+        return false;
+    }
+    // equal encodings are only guaranteed after optimize
+    return (_set == o->_set && _indexBits == o->_indexBits) || (*this <= *o && *o <= *this);
+}
+
+bool SymbolicNSF::operator!=(const NSF& other) const {
+    return !(*this == other);
+}
+
+/**
+ * The index variables of other are moved behind the ones of this set, every
+ * code of this set has to lead to the same element as some code of other.
+ **/
+bool SymbolicNSF::operator<=(const NSF& other) const {
+    const SymbolicNSF& o = dynamic_cast<const SymbolicNSF&> (other);
+    const std::vector<BDD>& variables = _manager.indexVariables(_indexBits + o._indexBits);
+    BDD indexCube = _bddManager.bddOne();
+    BDD otherIndexCube = _bddManager.bddOne();
+    for (unsigned int bit = 0; bit < _indexBits; bit++) {
+        indexCube *= variables.at(bit);
+    }
+    for (unsigned int bit = 0; bit < o._indexBits; bit++) {
+        otherIndexCube *= variables.at(_indexBits + bit);
+    }
+    BDD otherSet = rename(o._set, 0, _indexBits, o._indexBits);
+    BDD formulaCube = (_set.Support() * otherSet.Support()).ExistAbstract(indexCube * otherIndexCube, 0);
+    BDD different = (_set ^ otherSet).ExistAbstract(formulaCube, 0);
+    return (!different).ExistAbstract(otherIndexCube, 0).UnivAbstract(indexCube).IsOne();
+}
+
+unsigned int SymbolicNSF::depth() const {
+    return 1;
+}
+
+unsigned int SymbolicNSF::level() const {
+    return 1;
+}
+
+NTYPE SymbolicNSF::quantifier() const {
+    return _outerQuantifier;
+}
+
+/**
+ * Every element is a cofactor of the set, hence it is not larger than the set.
+ * The size of the set is used as estimate, it is also the size the operations
+ * on the nested set work on.
+ **/
+const unsigned int SymbolicNSF::maxBDDsize() const {
+    if (!_maxBDDsizeValid) {
+        _maxBDDsize = _set.nodeCount();
+        _maxBDDsizeValid = true;
+    }
+    return _maxBDDsize;
+}
+
+const unsigned int SymbolicNSF::leavesCount() const {
+    return _size;
+}
+
+const unsigned int SymbolicNSF::nsfCount() const {
+    return _size + 1;
+}
+
+void SymbolicNSF::print(bool verbose) const {
+    if (verbose) {
+        std::cout << (_outerQuantifier == NTYPE::EXISTS ? "E" : "A") << " l1 d1 ";
+        std::cout << "(" << _indexBits << " index variables, " << _set.nodeCount() << " nodes) ";
+    }
+    std::cout << "{";
+    for (const BDD& b : elements()) {
+        if (verbose) {
+            std::cout << (_innerQuantifier == NTYPE::EXISTS ? "E" : "A") << " l2 d0 ";
+        }
+        if (b.IsZero()) {
+            std::cout << "[B]";
+        } else if (b.IsOne()) {
+            std::cout << "[T]";
+        } else {
+            std::cout << "[" << b.nodeCount() << "]";
+            if (verbose) {
+                std::cout << std::endl;
+                b.print(0, 2);
+                std::cout << std::endl;
+            }
+        }
+    }
+    std::cout << "}";
+}
+
+/**
+ * Arbitrary functions do not commute with the encoding, they are applied
+ * to each element. Codes are kept, elements shared by several codes are
+ * processed once.
+ **/
+void SymbolicNSF::apply(const std::function<BDD(const BDD&)>& f) {
+    std::map<BDD, BDD, bool(*)(const BDD&, const BDD&)> memo(nodeOrder);
+    _set = apply(_set, 0, f, memo);
+    resize(_size);
+}
+
+void SymbolicNSF::apply(const BDD& clauses) {
+    _set *= clauses;
+    resize(_size);
+}
+
+/**
+ * Conjoining the clauses is a single BDD operation, hence it is never deferred.
+ **/
+void SymbolicNSF::applyLazily(const BDD& clauses) {
+    apply(clauses);
+}
+
+/**
+ * Cube does not contain index variables, hence abstracting the whole set
+ * abstracts every element.
+ **/
+void SymbolicNSF::applyAbstract(const BDD& clauses, const BDD& cube, const unsigned int vl) {
+    NTYPE quantifier = (vl == 1) ? _outerQuantifier : _innerQuantifier;
+    unsigned long nodesBefore = _set.nodeCount();
+    if (quantifier == NTYPE::EXISTS) {
+        _set = _set.AndAbstract(clauses, cube, 0);
+    } else {
+        _set = _set.UnivAbstract(cube) * clauses.UnivAbstract(cube);
+    }
+    _store.countFusedAbstraction(nodesBefore, _set.nodeCount());
+    resize(_size);
+}
+
+/**
+ * The product of all pairs is the conjunction of both sets after moving the
+ * index variables of other behind the ones of this set.
+ **/
+void SymbolicNSF::conjunct(const NSF& other, bool antichain) {
+    const SymbolicNSF& o = dynamic_cast<const SymbolicNSF&> (other);
+    _set *= rename(o._set, 0, _indexBits, o._indexBits);
+    _indexBits += o._indexBits;
+    resize((unsigned long) _size * o._size);
+    if (antichain) {
+        optimize();
+    }
+}
+
+/**
+ * Products are single BDD operations, hence they are never deferred.
+ **/
+void SymbolicNSF::conjunctLazily(const NSF& other, bool antichain) {
+    conjunct(other, antichain);
+}
+
+bool SymbolicNSF::hasPendingProduct() const {
+    return false;
+}
+
+void SymbolicNSF::removeAbstract(const BDD& variable, const unsigned int vl) {
+    NTYPE quantifier = (vl == 1) ? _outerQuantifier : _innerQuantifier;
+    _set = abstract(_set, variable, quantifier);
+    resize(_size);
+}
+
+/**
+ * Variables of the outer block split the nested set by replacing the
+ * variable with a new index variable. Only elements that depend on the
+ * variable are copied, the others are not counted twice.
+ **/
+unsigned int SymbolicNSF::remove(const BDD& variable, const unsigned int vl) {
+    if (vl != 1) {
+        _set = abstract(_set, variable, _innerQuantifier);
+        resize(_size);
+        return 0;
+    }
+    unsigned int size = _size;
+    unsigned int copies = countLeavesDependingOn(variable);
+    if (copies > 0) {
+        const BDD& index = _manager.indexVariables(_indexBits + 1).at(_indexBits);
+        _set = _set.Compose(index, variable.NodeReadIndex());
+        _indexBits++;
+        resize((unsigned long) size + copies);
+    }
+    return size - copies;
+}
+
+BDD SymbolicNSF::truncate(const std::vector<BDD>& cubesAtlevels) {
+    BDD ret = combine(abstract(_set, cubesAtlevels[1], _innerQuantifier));
+    return abstract(ret, cubesAtlevels[0], _outerQuantifier);
+}
+
+const BDD SymbolicNSF::evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) {
+    withinBudget = budget == 0 || (unsigned long) _set.nodeCount() <= budget;
+    if (!withinBudget) {
+        return BDD();
+    }
+    BDD ret = combine(abstract(_set, cubesAtlevels[1], _innerQuantifier));
+    if (!keepFirstLevel) {
+        ret = abstract(ret, cubesAtlevels[0], _outerQuantifier);
+    }
+    return ret;
+}
+
+/**
+ * Some element is unsatisfiable iff the index variables do not always lead to a
+ * satisfiable element.
+ **/
+bool SymbolicNSF::isUnsat() const {
+    if (_outerQuantifier == NTYPE::EXISTS) {
+        return _set.IsZero();
+    }
+    BDD indexCube = _bddManager.bddOne();
+    for (unsigned int bit = 0; bit < _indexBits; bit++) {
+        indexCube *= _manager.indexVariables(_indexBits).at(bit);
+    }
+    BDD formulaCube = _set.Support().ExistAbstract(indexCube, 0);
+    return !_set.ExistAbstract(formulaCube, 0).IsOne();
+}
+
+/**
+ * Elements have to be decoded to be returned individually.
+ **/
+std::vector<BDD> SymbolicNSF::leavesDependingOn(const BDD& variable, const unsigned int limit) const {
+    std::vector<BDD> leaves;
+    if (!(_set.Support() <= variable)) {
+        return leaves;
+    }
+    for (const BDD& b : elements()) {
+        if (limit > 0 && leaves.size() >= limit) {
+            break;
+        }
+        if (b.Support() <= variable) {
+            leaves.push_back(b);
+        }
+    }
+    return leaves;
+}
+
+/**
+ * Codes whose element differs in both cofactors of the variable are counted,
+ * without decoding the elements. Codes that lead to the same element are
+ * counted separately, hence the count is bounded by the size.
+ **/
+unsigned int SymbolicNSF::countLeavesDependingOn(const BDD& variable) const {
+    if (!(_set.Support() <= variable)) {
+        return 0;
+    }
+    BDD indexCube = _bddManager.bddOne();
+    for (unsigned int bit = 0; bit < _indexBits; bit++) {
+        indexCube *= _manager.indexVariables(_indexBits).at(bit);
+    }
+    BDD formulaCube = _set.Support().ExistAbstract(indexCube, 0);
+    BDD codes = (_set.Cofactor(variable) ^ _set.Cofactor(!variable)).ExistAbstract(formulaCube, 0);
+    double count = codes.CountMinterm(_indexBits);
+    return count < _size ? (unsigned int) count : _size;
+}
+
+/**
+ * Subsumption follows NodeNSF::compressConjunctive for nested sets of depth one.
+ * A second copy of the index variables relates each pair of elements, an element
+ * is dropped if it is subsumed by another one (for equal elements, the one with
+ * the smallest index is kept). Afterwards, the remaining elements are encoded
+ * canonically, this is the only place where the elements are decoded.
+ **/
+bool SymbolicNSF::optimize() {
+    if (_indexBits == 0) {
+        return false;
+    }
+    const std::vector<BDD>& variables = _manager.indexVariables(2 * _indexBits);
+    BDD indexCube = _bddManager.bddOne();
+    BDD otherIndexCube = _bddManager.bddOne();
+    for (unsigned int bit = 0; bit < _indexBits; bit++) {
+        indexCube *= variables.at(bit);
+        otherIndexCube *= variables.at(_indexBits + bit);
+    }
+    BDD other = rename(_set, 0, _indexBits, _indexBits);
+    BDD formulaCube = _set.Support().ExistAbstract(indexCube, 0);
+
+    // element i (this copy) is not a subset of element j (other copy) and vice versa
+    BDD notSubset = _set.AndAbstract(!other, formulaCube, 0);
+    BDD notSuperset = other.AndAbstract(!_set, formulaCube, 0);
+    bool keepSubsets = _outerQuantifier == NTYPE::FORALL;
+    BDD subsumes = keepSubsets ? !notSubset * (notSuperset + lessThan(_indexBits)) : !notSuperset * (notSubset + lessThan(_indexBits));
+    BDD dropped = rename(subsumes.ExistAbstract(indexCube, 0), _indexBits, 0, _indexBits);
+
+    unsigned int size = _size;
+    _set = keepSubsets ? _set + dropped : _set * !dropped;
+    std::vector<BDD> nestedSet = elements();
+    if (!dropped.IsZero()) {
+        // dropped elements are replaced by the neutral element of the outer quantifier
+        BDD neutral = keepSubsets ? _bddManager.bddOne() : _bddManager.bddZero();
+        if (nestedSet.size() > 1) {
+            nestedSet.erase(std::remove(nestedSet.begin(), nestedSet.end(), neutral), nestedSet.end());
+        }
+    }
+    encode(nestedSet);
+    return _size < size;
+}
+
+/**
+ * The nested set is compressed completely in both directions.
+ **/
+bool SymbolicNSF::optimize(bool left) {
+    return optimize();
+}
+
+BDD SymbolicNSF::abstract(const BDD& bdd, const BDD& cube, const NTYPE quantifier) const {
+    if (quantifier == NTYPE::EXISTS) {
+        return bdd.ExistAbstract(cube, 0);
+    } else {
+        return bdd.UnivAbstract(cube);
+    }
+}
+
+/**
+ * Combines all elements by the outer quantifier, i.e. abstracts the index variables.
+ **/
+BDD SymbolicNSF::combine(const BDD& bdd) const {
+    if (_indexBits == 0) {
+        return bdd;
+    }
+    const std::vector<BDD>& variables = _manager.indexVariables(_indexBits);
+    BDD indexCube = variables.front();
+    for (unsigned int bit = 1; bit < _indexBits; bit++) {
+        indexCube *= variables.at(bit);
+    }
+    return abstract(bdd, indexCube, _outerQuantifier);
+}
+
+/**
+ * Replaces the index variables from, ..., from + count - 1 by to, ..., to + count - 1.
+ **/
+BDD SymbolicNSF::rename(const BDD& bdd, unsigned int from, unsigned int to, unsigned int count) const {
+    if (count == 0 || from == to) {
+        return bdd;
+    }
+    const std::vector<BDD>& variables = _manager.indexVariables(std::max(from, to) + count);
+    std::vector<int> permutation(_bddManager.ReadSize());
+    for (unsigned int index = 0; index < permutation.size(); index++) {
+        permutation[index] = index;
+    }
+    for (unsigned int bit = 0; bit < count; bit++) {
+        permutation[variables.at(from + bit).NodeReadIndex()] = variables.at(to + bit).NodeReadIndex();
+    }
+    return bdd.Permute(permutation.data());
+}
+
+/**
+ * Strict order on the codes of both copies of the index variables, i.e. code
+ * of index variables 0, ..., count - 1 is less than code of count, ..., 2 * count - 1.
+ **/
+BDD SymbolicNSF::lessThan(unsigned int count) const {
+    const std::vector<BDD>& variables = _manager.indexVariables(2 * count);
+    BDD ret = _bddManager.bddZero();
+    for (unsigned int bit = 0; bit < count; bit++) {
+        const BDD& i = variables.at(bit);
+        const BDD& j = variables.at(count + bit);
+        ret = (!i * j) + (!(i ^ j) * ret);
+    }
+    return ret;
+}
+
+BDD SymbolicNSF::apply(const BDD& bdd, unsigned int bit, const std::function<BDD(const BDD&)>& f, std::map<BDD, BDD, bool(*)(const BDD&, const BDD&)>& memo) const {
+    auto it = memo.find(bdd);
+    if (it != memo.end()) {
+        return it->second;
+    }
+    BDD ret;
+    if (bit == _indexBits) {
+        ret = f(bdd);
+    } else {
+        const BDD& variable = _manager.indexVariables(_indexBits).at(bit);
+        BDD positive = apply(bdd.Cofactor(variable), bit + 1, f, memo);
+        BDD negative = apply(bdd.Cofactor(!variable), bit + 1, f, memo);
+        ret = variable.Ite(positive, negative);
+    }
+    memo.emplace(bdd, ret);
+    return ret;
+}
+
+std::vector<BDD> SymbolicNSF::elements() const {
+    std::vector<BDD> nestedSet;
+    collect(_set, 0, nestedSet);
+    std::sort(nestedSet.begin(), nestedSet.end(), nodeOrder);
+    nestedSet.erase(std::unique(nestedSet.begin(), nestedSet.end()), nestedSet.end());
+    return nestedSet;
+}
+
+void SymbolicNSF::collect(const BDD& bdd, unsigned int bit, std::vector<BDD>& elements) const {
+    if (bit == _indexBits) {
+        elements.push_back(bdd);
+        return;
+    }
+    const BDD& variable = _manager.indexVariables(_indexBits).at(bit);
+    BDD positive = bdd.Cofactor(variable);
+    BDD negative = bdd.Cofactor(!variable);
+    collect(positive, bit + 1, elements);
+    if (negative != positive) {
+        collect(negative, bit + 1, elements);
+    }
+}
+
+/**
+ * Encodes the given elements with as few index variables as possible.
+ **/
+void SymbolicNSF::encode(std::vector<BDD>& elements) {
+    std::sort(elements.begin(), elements.end(), nodeOrder);
+    elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+    _size = elements.size();
+    _indexBits = 0;
+    while ((1u << _indexBits) < _size) {
+        _indexBits++;
+    }
+    const std::vector<BDD>& variables = _manager.indexVariables(_indexBits);
+    _set = _bddManager.bddZero();
+    for (unsigned int code = 0; code < (1u << _indexBits); code++) {
+        BDD index = _bddManager.bddOne();
+        for (unsigned int bit = 0; bit < _indexBits; bit++) {
+            index *= ((code >> bit) & 1) ? variables.at(bit) : !variables.at(bit);
+        }
+        _set += index * elements.at(code < _size ? code : 0);
+    }
+    _maxBDDsizeValid = false;
+}
+
+/**
+ * Sets the number of elements to an upper bound after an operation on the set.
+ * Only index variables in the support of the set distinguish elements, hence
+ * the bound is tightened by the number of codes over these variables.
+ **/
+void SymbolicNSF::resize(unsigned long size) {
+    BDD support = _set.Support();
+    unsigned int bits = 0;
+    for (unsigned int bit = 0; bit < _indexBits; bit++) {
+        if (support <= _manager.indexVariables(_indexBits).at(bit)) {
+            bits++;
+        }
+    }
+    if (bits < 32) {
+        size = std::min(size, 1ul << bits);
+    }
+    _size = (unsigned int) std::min(size, (unsigned long) UINT_MAX);
+    _maxBDDsizeValid = false;
+}
@@ -0,0 +1,117 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "NSF.h"
+#include "NSFNodeStore.h"
+
+class ComputationManager;
+
+/**
+ * NSF for quantifier prefixes with two blocks, encoded as a single BDD.
+ * 
+ * The nested set {b_0, ..., b_n-1} is represented by one BDD over the formula
+ * variables and ceil(log2(n)) auxiliary index variables (see
+ * ComputationManager::indexVariables), such that assigning the binary code of
+ * k to the index variables yields b_k. Unused codes repeat b_0.
+ * 
+ * Joins, splits and subset removal are computed by BDD operations on the whole
+ * set (renaming index variables where needed), evaluation abstracts the index
+ * variables together with the outer block. Operations keep the encoding
+ * symbolic, hence several codes may lead to the same element and the size is
+ * an upper bound. Only optimize decodes the elements and encodes them
+ * canonically: ordered by DdNode and without duplicates.
+ **/
+class SymbolicNSF : public NSF {
+public:
+    SymbolicNSF(NSFNodeStore& store, ComputationManager& manager, const Cudd& bddManager, const std::vector<NTYPE>& quantifierSequence, const BDD& bdd);
+    SymbolicNSF(const SymbolicNSF& other);
+    virtual ~SymbolicNSF();
+
+    virtual NSF* copy() const override;
+
+    virtual bool operator==(const NSF& other) const override;
+    virtual bool operator!=(const NSF& other) const override;
+    virtual bool operator<=(const NSF& other) const override;
+
+    virtual unsigned int depth() const override;
+    virtual unsigned int level() const override;
+    virtual NTYPE quantifier() const override;
+
+    virtual const unsigned int maxBDDsize() const override;
+    virtual const unsigned int leavesCount() const override;
+    virtual const unsigned int nsfCount() const override;
+
+    virtual void print(bool verbose = false) const override;
+
+    virtual void apply(const std::function<BDD(const BDD&)>& f) override;
+    virtual void apply(const BDD& clauses) override;
+    virtual void applyLazily(const BDD& clauses) override;
+    virtual void applyAbstract(const BDD& clauses, const BDD& cube, const unsigned int vl) override;
+
+    virtual void conjunct(const NSF& other, bool antichain) override;
+    virtual void conjunctLazily(const NSF& other, bool antichain) override;
+    virtual bool hasPendingProduct() const override;
+
+    virtual void removeAbstract(const BDD& variable, const unsigned int vl) override;
+
+    using NSF::remove;
+    virtual unsigned int remove(const BDD& variable, const unsigned int vl) override;
+
+    virtual BDD truncate(const std::vector<BDD>& cubesAtlevels) override;
+    using NSF::evaluate;
+    virtual const BDD evaluate(const std::vector<BDD>& cubesAtlevels, const bool keepFirstLevel, const unsigned long budget, bool& withinBudget) override;
+    virtual bool isUnsat() const override;
+    virtual std::vector<BDD> leavesDependingOn(const BDD& variable, const unsigned int limit) const override;
+    virtual unsigned int countLeavesDependingOn(const BDD& variable) const override;
+
+    virtual bool optimize() override;
+    virtual bool optimize(bool left) override;
+
+private:
+    BDD abstract(const BDD& bdd, const BDD& cube, const NTYPE quantifier) const;
+    BDD combine(const BDD& bdd) const;
+    BDD rename(const BDD& bdd, unsigned int from, unsigned int to, unsigned int count) const;
+    BDD lessThan(unsigned int count) const;
+    BDD apply(const BDD& bdd, unsigned int bit, const std::function<BDD(const BDD&)>& f, std::map<BDD, BDD, bool(*)(const BDD&, const BDD&)>& memo) const;
+
+    std::vector<BDD> elements() const;
+    void collect(const BDD& bdd, unsigned int bit, std::vector<BDD>& elements) const;
+    void encode(std::vector<BDD>& elements);
+    void resize(unsigned long size);
+
+    NSFNodeStore& _store;
+    ComputationManager& _manager;
+    const Cudd& _bddManager;
+
+    NTYPE _outerQuantifier;
+    NTYPE _innerQuantifier;
+    BDD _set;
+    unsigned int _indexBits;
+    unsigned int _size;
+
+    mutable unsigned int _maxBDDsize;
+    mutable bool _maxBDDsizeValid;
+};
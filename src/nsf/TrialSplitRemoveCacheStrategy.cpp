@@ -0,0 +1,51 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "TrialSplitRemoveCacheStrategy.h"
+
+TrialSplitRemoveCacheStrategy::TrialSplitRemoveCacheStrategy() {
+}
+
+TrialSplitRemoveCacheStrategy::~TrialSplitRemoveCacheStrategy() {
+}
+
+unsigned int TrialSplitRemoveCacheStrategy::select(const std::vector<BDD>& variables, const NSF& nsf) const {
+    unsigned int selected = 0;
+    unsigned long minSize = 0;
+    for (unsigned int position = 0; position < variables.size(); position++) {
+        const BDD& variable = variables.at(position);
+        BDD negatedVariable = !variable;
+        std::vector<BDD> sample = nsf.leavesDependingOn(variable, SAMPLE_SIZE);
+        unsigned long size = 0;
+        if (!sample.empty()) {
+            // average over the sample, scaled to all leaves that are split
+            for (const BDD& leaf : sample) {
+                size += leaf.Restrict(variable).nodeCount() + leaf.Restrict(negatedVariable).nodeCount();
+            }
+            size = size * nsf.countLeavesDependingOn(variable) / sample.size();
+        }
+        if (position == 0 || size < minSize) {
+            selected = position;
+            minSize = size;
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,41 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include "RemoveCacheStrategy.h"
+
+/**
+ * Removes the variable that leads to the smallest BDDs, estimated by the
+ * average size of both cofactors of a sample of the leaves that contain it,
+ * times the number of these leaves.
+ **/
+class TrialSplitRemoveCacheStrategy : public RemoveCacheStrategy {
+public:
+    TrialSplitRemoveCacheStrategy();
+    ~TrialSplitRemoveCacheStrategy();
+
+    unsigned int select(const std::vector<BDD>& variables, const NSF& nsf) const override;
+
+private:
+    // number of leaves restricted per variable
+    static const unsigned int SAMPLE_SIZE = 16;
+};
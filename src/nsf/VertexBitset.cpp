@@ -0,0 +1,81 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "VertexBitset.h"
+
+VertexBitset::VertexBitset()
+: _size(0) {
+}
+
+VertexBitset::VertexBitset(const htd::vertex_t size)
+: _size(size)
+, _words((size + WORD_BITS - 1) / WORD_BITS, 0) {
+}
+
+htd::vertex_t VertexBitset::size() const {
+    return _size;
+}
+
+bool VertexBitset::contains(const htd::vertex_t vertex) const {
+    return (_words.at(vertex / WORD_BITS) >> (vertex % WORD_BITS)) & 1;
+}
+
+void VertexBitset::insert(const htd::vertex_t vertex) {
+    _words.at(vertex / WORD_BITS) |= (uint64_t) 1 << (vertex % WORD_BITS);
+}
+
+void VertexBitset::erase(const htd::vertex_t vertex) {
+    _words.at(vertex / WORD_BITS) &= ~((uint64_t) 1 << (vertex % WORD_BITS));
+}
+
+bool VertexBitset::empty() const {
+    for (uint64_t word : _words) {
+        if (word != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned int VertexBitset::count() const {
+    unsigned int count = 0;
+    for (uint64_t word : _words) {
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+bool VertexBitset::intersects(const VertexBitset& other) const {
+    for (unsigned int it = 0; it < _words.size(); it++) {
+        if (_words[it] & other._words[it]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+VertexBitset& VertexBitset::operator&=(const VertexBitset& other) {
+    for (unsigned int it = 0; it < _words.size(); it++) {
+        _words[it] &= other._words[it];
+    }
+    return *this;
+}
@@ -0,0 +1,58 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <htd/Vertex.hpp>
+
+/**
+ * Fixed-size set of vertex ids stored as bits, such that intersections are
+ * computed word by word.
+ **/
+class VertexBitset {
+public:
+    VertexBitset();
+    VertexBitset(const htd::vertex_t size);
+
+    // allocated for vertex ids below size (0 for default constructed sets)
+    htd::vertex_t size() const;
+
+    bool contains(const htd::vertex_t vertex) const;
+    void insert(const htd::vertex_t vertex);
+    void erase(const htd::vertex_t vertex);
+
+    bool empty() const;
+    unsigned int count() const;
+
+    // both sets must have the same size
+    bool intersects(const VertexBitset& other) const;
+    VertexBitset& operator&=(const VertexBitset& other);
+
+private:
+    static const unsigned int WORD_BITS = 64;
+
+    htd::vertex_t _size;
+    std::vector<uint64_t> _words;
+};
@@ -73,15 +73,17 @@ namespace solver {
 
                         const htd::ConstCollection<htd::vertex_t> forgottenVertices = decomposition->forgottenVertices(currentNode, child);
 
+                        // variables of the second block are removed all at once, such that they can be abstracted together
+                        std::vector<std::vector<BDD>> removed(2);
                         for (const auto& vertex : forgottenVertices) {
                             BDD variable = varMap.getBDDVariable("a", 0,{vertex});
                             BDD decision = varMap.getBDDVariable("d", 0,{vertex});
                             unsigned int vertexLevel = htd::accessLabel<int>(app.getInputInstance()->hypergraph->internalGraph().vertexLabel("level", vertex));
 
                             if (vertexLevel == 2) {
-                                nsfMan.remove(*tmpOuter, variable, vertexLevel);
+                                removed[1].push_back(variable);
                             } else if (vertexLevel == 1) {
-                                nsfMan.apply(*tmpOuter, getCubesAtLevels(currentNode), [&variable, &decision] (const BDD b) -> BDD {
+                                nsfMan.apply(*tmpOuter, getCubesAtLevels(currentNode), [&variable, &decision] (const BDD& b) -> BDD {
                                     // TODO: Could also be done by renaming all removed variables at once
                                     return (b.Restrict(!variable) * !decision) + (b.Restrict(variable) * decision);
                                 });
@@ -89,15 +91,14 @@ namespace solver {
                                 throw std::runtime_error("Invalid number of quantifiers");
                             }
                         }
+                        nsfMan.remove(*tmpOuter, removed);
 
                         app.getPrinter().solverIntermediateEvent(currentNode, *tmpOuter, "removing variables - done");
 
                         // Do introduction
                         app.getPrinter().solverIntermediateEvent(currentNode, *tmpOuter, "introducing clauses");
                         BDD currentClauses = this->currentClauses(currentNode);
-                        nsfMan.apply(*tmpOuter, getCubesAtLevels(currentNode), [&currentClauses](BDD bdd) -> BDD {
-                            return bdd *= currentClauses;
-                        });
+                        nsfMan.apply(*tmpOuter, getCubesAtLevels(currentNode), currentClauses);
                         app.getPrinter().solverIntermediateEvent(currentNode, *tmpOuter, "introducing clauses - done");
                         //                        app.getPrinter().solverIntermediateEvent(currentNode, *tmpOuter, "optimizing");
                         //                        nsfMan.optimize(*tmpOuter);
@@ -129,7 +130,7 @@ namespace solver {
                 optimizeCounter++;
                 if (optimizeCounter % 1 == 0) {
                     app.getPrinter().solverIntermediateEvent(currentNode, *cC, "subsets");
-                    nsfMan.apply(*cC, getCubesAtLevels(currentNode), [this](BDD bdd) -> BDD {
+                    nsfMan.apply(*cC, getCubesAtLevels(currentNode), [this](const BDD& bdd) -> BDD {
                         return removeSubsets(bdd);
                     });
                     app.getPrinter().solverIntermediateEvent(currentNode, *cC, "subsets - done");
@@ -69,18 +69,15 @@ namespace solver {
 
                         // Do removal
                         const htd::ConstCollection<htd::vertex_t> forgottenVertices = decomposition->forgottenVertices(currentNode, child);
-                        std::vector<htd::vertex_t> forgottenVerticesSorted(forgottenVertices.begin(), forgottenVertices.end());
-                        std::sort(forgottenVerticesSorted.begin(), forgottenVerticesSorted.end(), [this] (htd::vertex_t x1, htd::vertex_t x2) -> bool {
-                            unsigned int vl1 = htd::accessLabel<int>(app.getInputInstance()->hypergraph->internalGraph().vertexLabel("level", x1));
-                            unsigned int vl2 = htd::accessLabel<int>(app.getInputInstance()->hypergraph->internalGraph().vertexLabel("level", x2));
-                            return (vl1 > vl2); // vertices with higher level are to be removed first
-                        });
-
-                        for (const auto& vertex : forgottenVerticesSorted) {
+
+                        // all at once, such that variables of a level can be abstracted together
+                        std::vector<std::vector<BDD>> removed(app.getInputInstance()->quantifierCount());
+                        for (const auto& vertex : forgottenVertices) {
                             BDD variable = varMap.getBDDVariable("a", 0,{vertex});
                             unsigned int vertexLevel = htd::accessLabel<int>(app.getInputInstance()->hypergraph->internalGraph().vertexLabel("level", vertex));
-                            nsfMan.remove(*tmpOuter, variable, vertexLevel);
+                            removed[vertexLevel - 1].push_back(variable);
                         }
+                        nsfMan.remove(*tmpOuter, removed);
 
                         app.getPrinter().solverIntermediateEvent(currentNode, *tmpOuter, "removing variables - done");
 
@@ -88,9 +85,7 @@ namespace solver {
                         app.getPrinter().solverIntermediateEvent(currentNode, *tmpOuter, "introducing clauses");
                         // TODO: Only consider introduced vertices
                         BDD currentClauses = this->currentClauses(currentNode);
-                        nsfMan.apply(*tmpOuter, getCubesAtLevels(currentNode), [&currentClauses](BDD bdd) -> BDD {
-                            return bdd *= currentClauses;
-                        });
+                        nsfMan.apply(*tmpOuter, getCubesAtLevels(currentNode), currentClauses);
                         app.getPrinter().solverIntermediateEvent(currentNode, *tmpOuter, "introducing clauses - done");
 
                         if (first) {
@@ -0,0 +1,133 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include <iostream>
+#include <cstdlib>
+
+#include "../nsf/NodeNSF.h"
+#include "../nsf/NSFNodeStore.h"
+
+/**
+ * Checks that a lazily joined NSF keeps its product pending during the steps
+ * ComputationManager performs with default options after a join: intermediate
+ * unsat checks without budget, optimization, and removal of variables that
+ * only one factor depends on. Results are compared with an eagerly joined NSF.
+ **/
+
+namespace {
+
+    const unsigned int VARIABLE_COUNT = 7;
+    // levels of x0, ..., x6, the first factor uses x0, x1, x2, x4, x5, the second one x0, x3, x5, x6
+    const unsigned int VARIABLE_LEVELS[VARIABLE_COUNT] = {1, 1, 2, 2, 3, 3, 3};
+
+    BDD randomCNF(Cudd& manager, const std::vector<unsigned int>& variables) {
+        BDD cnf = manager.bddOne();
+        for (unsigned int clause = 0; clause < 4; clause++) {
+            BDD disjunction = manager.bddZero();
+            for (unsigned int variable : variables) {
+                if (rand() % 2) {
+                    disjunction += (rand() % 2) ? manager.bddVar(variable) : !manager.bddVar(variable);
+                }
+            }
+            if (!disjunction.IsZero()) {
+                cnf *= disjunction;
+            }
+        }
+        return cnf;
+    }
+
+    bool sameResult(const NSF& lazy, NSF& eager, const std::vector<BDD>& cubesAtLevels) {
+        // evaluating a copy materializes the product of the copy only
+        NSF* copy = lazy.copy();
+        bool same = copy->evaluate(cubesAtLevels, false) == eager.evaluate(cubesAtLevels, false);
+        delete copy;
+        return same;
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+    Cudd manager;
+    NSFNodeStore store;
+    std::vector<BDD> cubesAtLevels(3, manager.bddOne());
+    for (unsigned int variable = 0; variable < VARIABLE_COUNT; variable++) {
+        cubesAtLevels[VARIABLE_LEVELS[variable] - 1] *= manager.bddVar(variable);
+    }
+    for (unsigned int round = 0; round < rounds; round++) {
+        srand(round + 1);
+        std::vector<NTYPE> quantifierSequence;
+        NTYPE quantifier = (rand() % 2) ? NTYPE::EXISTS : NTYPE::FORALL;
+        for (unsigned int level = 1; level <= 3; level++) {
+            quantifierSequence.push_back(quantifier);
+            quantifier = (quantifier == NTYPE::EXISTS) ? NTYPE::FORALL : NTYPE::EXISTS;
+        }
+        BDD first = randomCNF(manager, {0, 1, 2, 4, 5});
+        BDD second = randomCNF(manager, {0, 3, 5, 6});
+
+        NodeNSF lazy(store, quantifierSequence, first);
+        NodeNSF eager(store, quantifierSequence, first);
+        NodeNSF other(store, quantifierSequence, second);
+        lazy.conjunctLazily(other, false);
+        eager.conjunct(other, false);
+
+        // removals of variables that only one factor depends on, interleaved with the checks of optimize
+        const unsigned int removed[4] = {1, 3, 4, 6};
+        for (unsigned int step = 0; step < 4; step++) {
+            bool withinBudget;
+            BDD refuted = lazy.evaluate(cubesAtLevels, false, 0, withinBudget);
+            if (withinBudget && !(refuted.IsZero() && eager.evaluate(cubesAtLevels, false).IsZero())) {
+                std::cerr << "Unsound refutation in round " << round << std::endl;
+                return 1;
+            }
+            lazy.optimize(step % 2 == 0);
+            eager.optimize(step % 2 == 0);
+            if (!lazy.hasPendingProduct()) {
+                std::cerr << "Product materialized in round " << round << " at step " << step << std::endl;
+                return 1;
+            }
+            if (!sameResult(lazy, eager, cubesAtLevels)) {
+                std::cerr << "Mismatch in round " << round << " at step " << step << std::endl;
+                return 1;
+            }
+            BDD variable = manager.bddVar(removed[step]);
+            unsigned int level = VARIABLE_LEVELS[removed[step]];
+            if (step < 3) {
+                // splits at levels 1 and 2, abstraction at the innermost level
+                lazy.remove(variable, level);
+                eager.remove(variable, level);
+            } else {
+                lazy.removeAbstract(variable, level);
+                eager.removeAbstract(variable, level);
+            }
+            if (!lazy.hasPendingProduct()) {
+                std::cerr << "Product materialized by removal in round " << round << " at step " << step << std::endl;
+                return 1;
+            }
+        }
+        if (!sameResult(lazy, eager, cubesAtLevels)) {
+            std::cerr << "Mismatch in round " << round << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Lazy joins stay pending and match eager joins on " << rounds << " instances" << std::endl;
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+Copyright 2016-2017, Guenther Charwat
+WWW: <http://dbai.tuwien.ac.at/proj/decodyn/dynqbf>.
+
+This file is part of dynQBF.
+
+dynQBF is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+dynQBF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with dynQBF.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include <iostream>
+#include <queue>
+#include <algorithm>
+#include <cstdlib>
+
+#include "../nsf/StandardDependencyScheme.h"
+
+/**
+ * Compares the native standard dependency scheme with a direct search for
+ * clause paths on random small instances: y depends on x iff x is left of y,
+ * their quantifiers differ, and clauses containing x and y are connected via
+ * clauses sharing existential variables right of x.
+ **/
+
+namespace {
+
+    bool occurs(const std::vector<htd::vertex_t>& clause, const htd::vertex_t vertex) {
+        return std::find(clause.begin(), clause.end(), vertex) != clause.end();
+    }
+
+    bool dependsByPath(const std::vector<NTYPE>& quantifierSequence, const std::vector<unsigned int>& vertexLevels, const std::vector<std::vector<htd::vertex_t>>& clauses, const htd::vertex_t x, const htd::vertex_t y) {
+        unsigned int levelX = vertexLevels.at(x);
+        unsigned int levelY = vertexLevels.at(y);
+        if (levelY <= levelX || quantifierSequence.at(levelX - 1) == quantifierSequence.at(levelY - 1)) {
+            return false;
+        }
+        std::vector<bool> reached(clauses.size(), false);
+        std::queue<unsigned int> open;
+        for (unsigned int clause = 0; clause < clauses.size(); clause++) {
+            if (occurs(clauses.at(clause), x)) {
+                reached[clause] = true;
+                open.push(clause);
+            }
+        }
+        while (!open.empty()) {
+            unsigned int clause = open.front();
+            open.pop();
+            if (occurs(clauses.at(clause), y)) {
+                return true;
+            }
+            for (htd::vertex_t vertex : clauses.at(clause)) {
+                unsigned int level = vertexLevels.at(vertex);
+                if (level <= levelX || quantifierSequence.at(level - 1) != NTYPE::EXISTS) {
+                    continue;
+                }
+                for (unsigned int other = 0; other < clauses.size(); other++) {
+                    if (!reached[other] && occurs(clauses.at(other), vertex)) {
+                        reached[other] = true;
+                        open.push(other);
+                    }
+                }
+            }
+        }
+        return false;
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned int rounds = argc > 1 ? atoi(argv[1]) : 5000;
+    for (unsigned int round = 0; round < rounds; round++) {
+        srand(round + 1);
+        unsigned int levelCount = 1 + rand() % 5;
+        unsigned int vertexCount = 1 + rand() % 16;
+        unsigned int clauseCount = rand() % 14;
+
+        std::vector<NTYPE> quantifierSequence;
+        NTYPE quantifier = (rand() % 2) ? NTYPE::EXISTS : NTYPE::FORALL;
+        for (unsigned int level = 1; level <= levelCount; level++) {
+            quantifierSequence.push_back(quantifier);
+            quantifier = (quantifier == NTYPE::EXISTS) ? NTYPE::FORALL : NTYPE::EXISTS;
+        }
+        std::vector<unsigned int> vertexLevels(vertexCount + 1, 0);
+        for (htd::vertex_t vertex = 1; vertex <= vertexCount; vertex++) {
+            vertexLevels[vertex] = 1 + rand() % levelCount;
+        }
+        std::vector<std::vector<htd::vertex_t>> clauses(clauseCount);
+        for (std::vector<htd::vertex_t>& clause : clauses) {
+            unsigned int size = 1 + rand() % 4;
+            for (unsigned int it = 0; it < size; it++) {
+                htd::vertex_t vertex = 1 + rand() % vertexCount;
+                if (!occurs(clause, vertex)) {
+                    clause.push_back(vertex);
+                }
+            }
+        }
+
+        StandardDependencyScheme scheme(quantifierSequence, vertexLevels, clauses);
+        for (htd::vertex_t x = 1; x <= vertexCount; x++) {
+            VertexBitset dependencies(vertexCount + 1);
+            scheme.addDependencies(x, dependencies);
+            for (htd::vertex_t y = 1; y <= vertexCount; y++) {
+                if (dependencies.contains(y) != dependsByPath(quantifierSequence, vertexLevels, clauses, x, y)) {
+                    std::cerr << "Mismatch in round " << round << " for variables " << x << " and " << y << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+    std::cout << "Standard dependency scheme matches the clause path search on " << rounds << " instances" << std::endl;
+    return 0;
+}